@@ -12,6 +12,18 @@
 
 #include <xc.h> // include processor files - each processor file is guarded.  
 
+#define CRC16_INIT 0xFFFF //CRC16 of no bytes, where CRC16Update() starts
+
+//How CRC16.c works it out, all give the same CRC16.  host/crc16-bench
+//compares their speed.
+#define CRC16_TABLE_256 0 //512 bytes of table, a read per byte
+#define CRC16_TABLE_16 1 //32 bytes of table, a read per nibble
+#define CRC16_BITWISE 2 //No table, 8 shifts per byte
+#ifndef CRC16_METHOD
+#define CRC16_METHOD CRC16_TABLE_256
+#endif
+
 unsigned short int CRC16 (const unsigned char *, unsigned short int);
+unsigned short int CRC16Update (unsigned short int, unsigned char); //CRC16 so far, next byte
 
 #endif	/* INC_CRC16_H */
\ No newline at end of file
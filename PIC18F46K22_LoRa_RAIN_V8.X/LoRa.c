@@ -1,16 +1,68 @@
 #include <xc.h>
 #include "LoRa.h"
+#include "hal.h"
+#include "log.h"
+#include "clock.h"
 #include <stdint.h>
 #include <stdio.h>
 
-#define DEBUG 1
+//What the module was last configured with.  The RFM95W keeps its registers
+//in sleep, so these stay valid while the PIC sleeps but not after a reset.
+static uint8_t configured = 0;
+static uint32_t configuredFRF;
+static uint8_t configuredSyncWord;
+static uint8_t configuredPA;
+static uint8_t awake = 0; //In standby since LoRaStandbyMode(), so nothing has reset it
 
 /**
- * Configures PIC and LoRa module to start with specified frequency in MHz
+ * Checks that the module still has the configuration from an earlier
+ * LoRaWake() and is asleep or in standby in LoRa mode.  After a power cycle
+ * it comes up in FSK standby instead.
+ * @return The mode it is in, SLEEP_MODE or STANDBY_MODE, or 0xFF if it has lost its configuration
+ */
+static uint8_t LoRaConfigRetained(){
+    if(!configured){
+        return 0xFF;
+    }
+    if(LoRaGetVersion() != LORA_VERSION){
+        return 0xFF;
+    }
+    uint8_t opMode = readOpModeRegister() & (LORA_MODE|0b00000111);
+    if(opMode == (LORA_MODE|SLEEP_MODE) || opMode == (LORA_MODE|STANDBY_MODE)){
+        return opMode & 0b00000111;
+    }
+    return 0xFF;
+}
+
+/**
+ * Configures PIC and LoRa module to start with the specified frequency
+ * and waits until the FIFO can be used.
+ */
+void LoRaStart(uint32_t frf, uint8_t syncWord){
+    if(LoRaWake(frf, syncWord) == LORA_WAKE_ASLEEP){
+        LoRaOscillatorStart();
+    }
+}
+
+/**
+ * Takes the module from sleep to standby and waits for its oscillator, after
+ * LoRaWake() has found it asleep.
+ */
+void LoRaOscillatorStart(){
+    LoRaStandbyMode();
+    __delay_ms(LORA_OSC_START_MS); //Before the FIFO can be used
+}
+
+/**
+ * Configures PIC and LoRa module to start with the specified frequency
  * from PIC18F46K22_LoRA_UVVIS_V2
+ * If the module has kept its configuration since the last call (warm start)
+ * only the settings that have changed are written and it is left asleep,
+ * so the caller can choose when to start its oscillator.
+ * @return LORA_WAKE_READY, LORA_WAKE_ASLEEP or LORA_WAKE_COLD
  */
-void LoRaStart(float freq, uint8_t syncWord){
-    printf("LoRa Start\r\n");
+uint8_t LoRaWake(uint32_t frf, uint8_t syncWord){
+    LOG_DEBUG(("LoRa Start\r\n"));
     //Configure pin for LoRa module reset
     ANSELAbits.ANSA2=0; //Digital input buffer enabled
     
@@ -43,21 +95,39 @@ void LoRaStart(float freq, uint8_t syncWord){
     //SPI Enable
     SSP2CON1bits.SSPEN=1; //Enabled
     
-    //LoRaReset();
-    if(DEBUG){
-        printf("Set LoRa Mode\r\n");
+    uint8_t mode = awake ? STANDBY_MODE : LoRaConfigRetained();
+    if(mode != 0xFF){
+        if(frf != configuredFRF){
+            LoRaSetFRF(frf);
+            configuredFRF = frf;
+        }
+        if(syncWord != configuredSyncWord){
+            SPI2WriteByte(SYNC_VALUE_REG, syncWord);
+            configuredSyncWord = syncWord;
+        }
+        if(mode == STANDBY_MODE){
+            return LORA_WAKE_READY; //Woken earlier
+        }
+        LOG_DEBUG(("LoRa warm start\r\n"));
+        LOG_EVENT(EV_LORA_WARM, 0);
+        return LORA_WAKE_ASLEEP;
     }
-    __delay_ms(10);
+    
+    //LoRaReset();
+    LOG_DEBUG(("Set LoRa Mode\r\n"));
+    LOG_EVENT(EV_LORA_COLD, 0);
+    clockSleepMs(10);
     setLoRaMode();
-    __delay_ms(10);
-    if(DEBUG){
-        printf("LoRa load optimal register values\r\n");
-    }
+    clockSleepMs(10);
+    LOG_DEBUG(("LoRa load optimal register values\r\n"));
     LoRaOptimalLoad(syncWord);
-    if(DEBUG){
-        printf("LoRa set frequency\r\n");
-    }
-    LoRaSetFrequency(freq); //Can only set in standby or sleep modes
+    LOG_DEBUG(("LoRa set frequency\r\n"));
+    LoRaSetFRF(frf); //Can only set in standby or sleep modes
+    configured = 1;
+    configuredFRF = frf;
+    configuredSyncWord = syncWord;
+    configuredPA = LORA_PA_DEFAULT;
+    return LORA_WAKE_COLD; //LoRaOptimalLoad() left it in standby
 }
 
 uint8_t LoRaGetVersion(){
@@ -71,7 +141,7 @@ void LoRaReset(){
     LATAbits.LA2=0; //In reset
     __delay_ms(1);
     TRISAbits.RA2=1; //Configure port as input (goes high-Z)
-    __delay_ms(5);
+    clockSleepMs(5);
 }
 
 void setLoRaMode(){
@@ -102,24 +172,14 @@ void LoRaMode_RXActive(){
  * @param data
  */
 void SPI2WriteByte(uint8_t address, uint8_t data){
-    SSP2IF=0; //Clear interrupt flag
-    LATDbits.LATD3=0; //Set SS low
+    HAL_SPI2_SELECT(); //Set SS low
     __delay_us(5);
     address = address|0x80; //bit 7 set to indicate a register write
-    SSP2BUF=address; //Write address to SPI buffer 
-    while(!SSP2IF){
-        //Wait for transmission to complete
-    }
-    SSP2IF=0; //Clear interrupt flag
+    HAL_SPI2_WRITE(address); //Write address to SPI buffer
     __delay_us(5);
-    SSP2BUF=data; 
-    while(!SSP2IF){
-        //Wait for transmission and reception to complete
-    }
+    HAL_SPI2_WRITE(data); //A byte is received but this is not used.
     __delay_us(5);
-    LATDbits.LATD3=1; //Set SS high
-    SSP2IF=0; //Clear interrupt flag
-    uint8_t dataByte = SSP2BUF; //A byte has been received but this is not used.
+    HAL_SPI2_DESELECT(); //Set SS high
 }
 
 /**
@@ -130,38 +190,122 @@ void SPI2WriteByte(uint8_t address, uint8_t data){
  * @return 
  */
 uint8_t SPI2ReadByte(uint8_t address){
-    SSP2IF=0; //Clear interrupt flag
-    LATDbits.LATD3=0; //Set SS low
-    SSP2BUF=address; //Write data to SPI buffer
-    while(!SSP2IF){
-        //Wait for transmission to complete
-    }
-    SSP2IF=0; //Clear interrupt flag
-    SSP2BUF=0; //Data byte - for a read, set to 0
-    while(!SSP2IF){
-        //Wait for transmission and reception to complete
-    }
-    SSP2IF=0; //Clear interrupt flag
+    uint8_t dataByte;
+    HAL_SPI2_SELECT(); //Set SS low
+    HAL_SPI2_WRITE(address); //Write address to SPI buffer
+    HAL_SPI2_TRANSFER(0, dataByte); //Data byte - for a read, set to 0
     //__delay_us(20);
-    LATDbits.LATD3=1; //Set SS high
-    uint8_t dataByte = SSP2BUF;
+    HAL_SPI2_DESELECT(); //Set SS high
     return dataByte;
 }
 
-/* 
- * Transmits a data packet.
+/**
+ * SPI2WriteBurst
+ * Writes an address byte followed by length data bytes with SS held low.
+ * The module moves on to the next register after each byte (or moves
+ * FifoAddrPtr for the FIFO), so one transaction fills a run of consecutive
+ * registers or a whole packet.
+ * @param address  First register
+ * @param data
+ * @param length
  */
-void LoRaTXData(uint8_t* data, uint8_t dataLength){
+void SPI2WriteBurst(uint8_t address, const uint8_t* data, uint8_t length){
+#if LORA_SPI_BURST
+    HAL_SPI2_SELECT(); //Set SS low
+    address = address|0x80; //bit 7 set to indicate a register write
+    HAL_SPI2_WRITE(address);
+    while(length--){
+        HAL_SPI2_WRITE(*data++);
+    }
+    HAL_SPI2_DESELECT(); //Set SS high
+#else
+    //One transaction per byte
+    while(length--){
+        SPI2WriteByte(address, *data++);
+        if(address != FIFO_REG){
+            address++;
+        }
+    }
+#endif
+}
+
+/**
+ * SPI2ReadBurst
+ * Writes an address byte then reads length bytes back with SS held low.
+ * @param address  First register
+ * @param data  Destination
+ * @param length
+ */
+void SPI2ReadBurst(uint8_t address, uint8_t* data, uint8_t length){
+#if LORA_SPI_BURST
+    uint8_t dataByte;
+    HAL_SPI2_SELECT(); //Set SS low
+    HAL_SPI2_WRITE(address);
+    while(length--){
+        HAL_SPI2_TRANSFER(0, dataByte); //Dummy byte clocks the next register out
+        *data++ = dataByte;
+    }
+    HAL_SPI2_DESELECT(); //Set SS high
+#else
+    //One transaction per byte
+    while(length--){
+        *data++ = SPI2ReadByte(address);
+        if(address != FIFO_REG){
+            address++;
+        }
+    }
+#endif
+}
+
+/**
+ * LoRaFIFOBegin
+ * Opens the FIFO for a packet to be written into it a byte at a time with
+ * LoRaFIFOWrite(), so it can be made up on the way in without a buffer.
+ * With LORA_SPI_BURST SS is held low until LoRaFIFOEnd(), so nothing else
+ * may use SPI2 in between.
+ */
+void LoRaFIFOBegin(){
     //Must be in standby mode for this to work
     LoRaStandbyMode();
-    printf("Transmitting.\r\n");
     SPI2WriteByte(FIFO_ADD_PTR_REG, 0);
     SPI2WriteByte(PAYLOAD_LENGTH_REG, 0);
-    
+#if LORA_SPI_BURST
+    HAL_SPI2_SELECT(); //Set SS low
+    HAL_SPI2_WRITE(FIFO_REG|0x80); //bit 7 set to indicate a register write
+#endif
+}
 
-    for(uint8_t i=0;i<dataLength;i++){
-        SPI2WriteByte(FIFO_REG, data[i]);
-    }
+/**
+ * LoRaFIFOWrite
+ * Writes the next packet byte, after LoRaFIFOBegin().
+ * @param data
+ */
+void LoRaFIFOWrite(uint8_t data){
+#if LORA_SPI_BURST
+    HAL_SPI2_WRITE(data);
+#else
+    SPI2WriteByte(FIFO_REG, data); //One transaction per byte
+#endif
+}
+
+/**
+ * LoRaFIFOEnd
+ * Closes the FIFO after the last byte.
+ */
+void LoRaFIFOEnd(){
+#if LORA_SPI_BURST
+    HAL_SPI2_DESELECT(); //Set SS high
+#endif
+}
+
+/**
+ * LoRaTXStart
+ * Transmits the packet in the FIFO.
+ * @param dataLength  Bytes written since LoRaFIFOBegin()
+ */
+void LoRaTXStart(uint8_t dataLength){
+    LOG_DEBUG(("Transmitting.\r\n"));
+    LOG_EVENT(EV_TX_START, dataLength);
     SPI2WriteByte(PAYLOAD_LENGTH_REG, dataLength);
     LoRaTXMode(); //Set TX mode to send the message
     
@@ -169,6 +313,18 @@ void LoRaTXData(uint8_t* data, uint8_t dataLength){
     //You can check TxDone interrupt to see if it's finished.
 }
 
+/* 
+ * Transmits a data packet.
+ */
+void LoRaTXData(uint8_t* data, uint8_t dataLength){
+    LoRaFIFOBegin();
+    for(uint8_t i=0;i<dataLength;i++){
+        LoRaFIFOWrite(data[i]);
+    }
+    LoRaFIFOEnd();
+    LoRaTXStart(dataLength);
+}
+
 /**
  * Sets the LoRa module into standby mode
  */
@@ -177,6 +333,7 @@ void LoRaStandbyMode(){
     regValue = regValue & 0b11111000; //Blank out other modes
     regValue = regValue | STANDBY_MODE; //Set bit 0 high and leave others as is
     writeOpModeRegister(regValue); //Write the value back
+    awake = 1;
 }
 
 void LoRaSleepMode(){
@@ -184,6 +341,7 @@ void LoRaSleepMode(){
     regValue = regValue & 0b11111000; //Blank out other modes
     regValue = regValue | SLEEP_MODE;
     writeOpModeRegister(regValue); //Write the value back
+    awake = 0;
 }
 
 void LoRaFreqSynthRXMode(){
@@ -201,7 +359,7 @@ void LoRaFreqSynthTXMode(){
 }
 
 void LoRaTXMode(){
-    printf("TX Mode\r\n");
+    LOG_DEBUG(("TX Mode\r\n"));
     uint8_t regValue = readOpModeRegister(); //Read whats in there already
     regValue = regValue & 0b11111000; //Blank out other modes
     regValue = regValue | TX_MODE; //Set bit 0 high and leave others as is
@@ -215,36 +373,52 @@ void LoRaRXContinuousMode(){
     writeOpModeRegister(regValue); //Write the value back02
 }
 
+/**
+ * Works out the FRF register value for a frequency in Hz at run time.
+ * Use LORA_FRF() instead when the frequency is a constant.
+ * @param  Frequency in Hz
+ * @return FRF register value
+ */
+uint32_t LoRaFRF(uint32_t freqHz){
+    return LORA_FRF(freqHz);
+}
+
 /**
  * Sets the frequency of the LoRa module
- * @param  Frequency in MHz
+ * @param  FRF register value, from LORA_FRF() or LoRaFRF()
  * 
  * Frf = XOSC * FreqReg/2^19
  * Resolution is 61.035Hz for XOSC=32MHz.
  */
-void LoRaSetFrequency(float freqMHz){
-    uint32_t intermediate = (freqMHz*16384);
-    //printf("Intermediate %lu\r\n",intermediate);
-    uint8_t msb = (intermediate>>16) & 0xFF; //Extract MSB
-    uint8_t mid = (intermediate>>8)& 0xFF; //Extract mid byte
-    uint8_t lsb = intermediate & 0xFF; //Extract LSB
-    //printf("MSB %d, MID %d, LSB %d\r\n",msb,mid,lsb);
-    SPI2WriteByte(FRF_MSB_REG,msb);
-    SPI2WriteByte(FRF_MID_REG,mid);
-    SPI2WriteByte(FRF_LSB_REG,lsb);
+void LoRaSetFRF(uint32_t frf){
+    uint8_t frfBytes[3];
+    frfBytes[0] = (frf>>16) & 0xFF; //Extract MSB
+    frfBytes[1] = (frf>>8)& 0xFF; //Extract mid byte
+    frfBytes[2] = frf & 0xFF; //Extract LSB
+    SPI2WriteBurst(FRF_MSB_REG, frfBytes, 3);
+}
+
+/**
+ * Sets the transmit power.  The register is only written when it has changed
+ * since the last call or LoRaStart() configured the module from scratch.
+ * Call after LoRaStart(), in standby or sleep mode.
+ * @param paConfig  RegPaConfig value, from LORA_PA_BOOST()
+ */
+void LoRaSetPower(uint8_t paConfig){
+    if(paConfig != configuredPA){
+        SPI2WriteByte(PA_CONFIG_REG, paConfig);
+        configuredPA = paConfig;
+    }
 }
 
 /**
  * Gets the centre frequency from the device.
- * @return Frequency in MHz.
+ * @return Frequency in Hz.
  */
-float LoRaGetFrequency(){
-    uint8_t msb = SPI2ReadByte(FRF_MSB_REG);
-    uint8_t mid = SPI2ReadByte(FRF_MID_REG);
-    uint8_t lsb = SPI2ReadByte(FRF_LSB_REG);
-    uint32_t intermediate = (uint32_t)msb<<16 | (uint32_t)mid<<8 | lsb;
-    float freqMHz = (float)intermediate/16384.0;
-    return freqMHz;
+uint32_t LoRaGetFrequency(){
+    uint8_t frf[3];
+    SPI2ReadBurst(FRF_MSB_REG, frf, 3);
+    return LORA_FRF_HZ((uint32_t)frf[0]<<16 | (uint32_t)frf[1]<<8 | frf[2]);
 }
 
 
@@ -259,58 +433,70 @@ void LoRaClearIRQFlags(){
 
 
 /**
- * Dumps the contents of all registers to printf
+ * Dumps the contents of all registers to the log at LOG_LEVEL_DEBUG, and does
+ * nothing below it
  */
 void LoRaDumpRegisters(){
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
     for(uint8_t reg=0x0;reg<0x20;reg++){
-        printf("Reg %X:%X\r\n", reg, SPI2ReadByte(reg));
+        LOG_DEBUG(("Reg %X:%X\r\n", reg, SPI2ReadByte(reg)));
     }
+#endif
 }
 
+/**
+ * Register load for LoRaOptimalLoad(), kept in program memory.
+ * Each run is a length, the first register and then the values for that many
+ * consecutive registers, so a run goes out as one SPI burst.  A zero length
+ * ends the table.
+ * The FRF registers (0x06 to 0x08) are left out because LoRaSetFRF()
+ * always writes them straight afterwards, and so is RegRxNbBytes (0x13) which
+ * is read only.
+ */
+static const uint8_t optimalLoad[] = {
+    4, PA_CONFIG_REG, LORA_PA_DEFAULT, 0x09, 0x2B, 0x23, //PA_BOOST 17dBm, ramp, OCP 100mA, LNA
+    4, FIFO_TX_BASE_ADDR_REG, 0, 0, 0, 0, //FIFO TX and RX base, IRQ mask
+    5, MODEM_CONFIG_1_REG, //Modem settings from LoRa.h, BW 125k CR 4/5 explicit header, SF7, preamble 8
+        LORA_BW << 4 | LORA_CR << 1 | LORA_IMPLICIT_HEADER,
+        LORA_SF << 4 | LORA_PAYLOAD_CRC << 2,
+        0x64, //Symbol timeout
+        LORA_PREAMBLE >> 8, LORA_PREAMBLE & 0xFF,
+    4, MAX_PAYLOAD_LENGTH_REG, 0xFF, 0, 0, LORA_LDRO << 3 | 0x04, //AGC auto on
+    3, 0x2F, 0x45, 0x55, 0xC3,
+    1, 0x33, 0x27, //Invert IQ off
+    2, 0x36, 0x03, 0x0A,
+    2, SYNC_VALUE_REG, 0x12, 0x49, //Sync word is replaced with the syncWord argument
+    1, DIO_MAPPING_1_REG, 0x40, //TxDone on DIO0
+    1, TXCO_REG, 0x09,
+    1, PA_DAC_REG, 0x84,
+    4, AGC_REF_REG, 0x1C, 0x0E, 0x5B, 0xCC,
+    1, 0x70, 0xD0,
+    0
+};
+
+#define OPTIMAL_LOAD_MAX_RUN 5 //Longest run in optimalLoad[]
+
 /**
  * Loads all the registers required to setup an optimal configuration
  */
 void LoRaOptimalLoad(uint8_t syncWord){
+    const uint8_t* table = optimalLoad;
+    uint8_t run[OPTIMAL_LOAD_MAX_RUN];
+    uint8_t length;
     LoRaSleepMode(); //Can only change to LoRa mode in sleep mode
     setLoRaMode();
     LoRaStandbyMode();
-    __delay_ms(10); //Need a delay to come up to standby mode
-    SPI2WriteByte(0x06, 0xD9);
-    SPI2WriteByte(0x07, 0);
-    SPI2WriteByte(0x08, 0);
-    SPI2WriteByte(0x09, 0x8F);
-    SPI2WriteByte(0x0A, 0x09);
-    SPI2WriteByte(0x0B, 0x2B);
-    SPI2WriteByte(0x0C, 0x23);
-    SPI2WriteByte(0x0E, 0);
-    SPI2WriteByte(0x0F, 0);
-    SPI2WriteByte(0x10, 0);
-    SPI2WriteByte(0x11, 0);
-    SPI2WriteByte(0x13, 0);
-    SPI2WriteByte(0x1D, 0x72);
-    SPI2WriteByte(0x1E, 0x70);
-    SPI2WriteByte(0x1F, 0x64);
-    SPI2WriteByte(0x20, 0);
-    SPI2WriteByte(0x21, 0x08);
-    SPI2WriteByte(0x23, 0xFF);
-    SPI2WriteByte(0x24, 0);
-    SPI2WriteByte(0x25, 0);
-    SPI2WriteByte(0x26, 0x04);
-    SPI2WriteByte(0x2F, 0x45);
-    SPI2WriteByte(0x30, 0x55);
-    SPI2WriteByte(0x31, 0xC3);
-    SPI2WriteByte(0x33, 0x27);
-    SPI2WriteByte(0x36, 0x03);
-    SPI2WriteByte(0x37, 0x0A);
-    SPI2WriteByte(0x39, syncWord); //Sync word was 0x12
-    SPI2WriteByte(0x3A, 0x49);
-    SPI2WriteByte(0x4B, 0x09);
-    SPI2WriteByte(0x4D, 0x84);
-    SPI2WriteByte(0x61, 0x1C);
-    SPI2WriteByte(0x62, 0x0E);
-    SPI2WriteByte(0x63, 0x5B);
-    SPI2WriteByte(0x64, 0xCC);
-    SPI2WriteByte(0x70, 0xD0);
+    clockSleepMs(10); //Need a delay to come up to standby mode
+    while((length = *table++) != 0){
+        uint8_t address = *table++;
+        for(uint8_t i=0;i<length;i++){
+            run[i] = *table++; //Copy from program memory
+            if(address + i == SYNC_VALUE_REG){
+                run[i] = syncWord; //Sync word was 0x12
+            }
+        }
+        SPI2WriteBurst(address, run, length);
+    }
 }
 
 
@@ -14,6 +14,7 @@
 
 #include <stdint.h>
 #include "defines.h"
+#include "airtime.h"
 
 //NB ONLY LoRa REGISTERS ARE DEFINED - FSK/OOK MODE REGISTERS ARE NOT!
 #define FIFO_REG 0x00
@@ -69,6 +70,12 @@
 #define AGC_THRESH_2_REG 0x63
 #define AGC_THRESH_3_REG 0x64
 
+#define LORA_VERSION 0x12 //VERSION_REG value for the SX1276/RFM95W
+
+//RegPaConfig for 2 to 17dBm from the PA_BOOST pin, the only PA output on the RFM95W
+#define LORA_PA_BOOST(dBm) (0x80 | ((dBm) - 2))
+#define LORA_PA_DEFAULT LORA_PA_BOOST(17) //Loaded by LoRaOptimalLoad()
+
 
 //Operating modes
 #define STANDBY_MODE 0b00000001
@@ -93,9 +100,46 @@
 #define BW250k 0b1000
 #define BW500k 0b1001
 
+#define LORA_BW_HZ(bw) ((bw) == BW7k8 ? 7800UL : (bw) == BW10k4 ? 10400UL : (bw) == BW15k6 ? 15600UL : \
+                        (bw) == BW20k8 ? 20800UL : (bw) == BW31k25 ? 31250UL : (bw) == BW41k7 ? 41700UL : \
+                        (bw) == BW62k5 ? 62500UL : (bw) == BW125k ? 125000UL : (bw) == BW250k ? 250000UL : 500000UL)
+
+//Modem settings loaded by LoRaOptimalLoad(), also used for the time on air
+#define LORA_BW BW125k
+#define LORA_SF 7
+#define LORA_CR 1 //Coding rate 4/5
+#define LORA_PREAMBLE 8
+#define LORA_IMPLICIT_HEADER 0
+#define LORA_PAYLOAD_CRC ((PACKET_CRC & PACKET_CRC_RADIO) ? 1 : 0) //See PACKET_CRC in defines.h
+#define LORA_LDRO LORA_LOW_DATA_RATE(LORA_SF, LORA_BW_HZ(LORA_BW))
+
+//Time on air in us for a payload of length bytes with the settings above
+#define LORA_TIME_ON_AIR_US(length) LORA_AIRTIME_US(LORA_SF, LORA_BW_HZ(LORA_BW), LORA_CR, LORA_PREAMBLE, \
+                                                    LORA_IMPLICIT_HEADER, LORA_PAYLOAD_CRC, length)
+
+//FRF register value for a frequency in Hz, FRF = Hz * 2^19 / 32MHz = Hz * 256 / 15625.
+//Split so it stays in 32 bits, and folds to a constant when hz is one.
+#define LORA_FRF(hz) (((hz) / 15625UL) * 256UL + (((hz) % 15625UL) * 256UL + 7812UL) / 15625UL)
+//Frequency in Hz for an FRF register value (rounded down)
+#define LORA_FRF_HZ(frf) (((frf) >> 8) * 15625UL + (((frf) & 0xFFUL) * 15625UL >> 8))
+
+//Set to 0 to send every register and FIFO byte in its own SPI transaction
+#ifndef LORA_SPI_BURST
+#define LORA_SPI_BURST 1
+#endif
+
+
 
+//What LoRaWake() had to do
+#define LORA_WAKE_READY 0 //Already in standby, the FIFO can be used
+#define LORA_WAKE_ASLEEP 1 //Kept its configuration, LoRaOscillatorStart() before the FIFO
+#define LORA_WAKE_COLD 2 //Configured from the start, idling for at least LORA_COLD_START_MS
+#define LORA_OSC_START_MS 1 //Sleep to standby
+#define LORA_COLD_START_MS 30 //clockSleepMs() calls in a cold start
 
-void LoRaStart(float, uint8_t);
+void LoRaStart(uint32_t, uint8_t); //FRF register value and sync word, returns once the FIFO can be used
+uint8_t LoRaWake(uint32_t, uint8_t); //As LoRaStart(), leaving it asleep on a warm start
+void LoRaOscillatorStart(void); //Sleep to standby, returns once the FIFO can be used
 uint8_t LoRaGetVersion();
 void LoRaReset();
 void setLoRaMode(); //Sets module into LoRa mode
@@ -109,10 +153,18 @@ void LoRaTXMode();
 void LoRaRXContinuousMode();
 void LoRaMode_RXActive(); //Set LoRa mode with receiver always active
 void LoRaTXData(uint8_t* , uint8_t); //Sends a data packet of length dataLength
+void LoRaFIFOBegin(); //Then LoRaFIFOWrite() for each byte and LoRaFIFOEnd()
+void LoRaFIFOWrite(uint8_t);
+void LoRaFIFOEnd();
+void LoRaTXStart(uint8_t); //Sends the dataLength bytes in the FIFO
 void SPI2WriteByte(uint8_t, uint8_t);
 uint8_t SPI2ReadByte(uint8_t);
-void LoRaSetFrequency(float);
-float LoRaGetFrequency(void);
+void SPI2WriteBurst(uint8_t, const uint8_t*, uint8_t); //Writes consecutive registers or the FIFO
+void SPI2ReadBurst(uint8_t, uint8_t*, uint8_t); //Reads consecutive registers or the FIFO
+uint32_t LoRaFRF(uint32_t); //FRF register value for a frequency in Hz
+void LoRaSetFRF(uint32_t);
+void LoRaSetPower(uint8_t); //RegPaConfig value, from LORA_PA_BOOST()
+uint32_t LoRaGetFrequency(void); //In Hz
 uint8_t LoRaGetIRQFlags();
 void LoRaClearIRQFlags();
 
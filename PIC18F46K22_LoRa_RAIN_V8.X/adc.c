@@ -0,0 +1,92 @@
+/**
+ * adc.c
+ * Battery and temperature conversions chained on ADIF, see adc.h
+ */
+
+#include <xc.h>
+#include "adc.h"
+#include "hal.h"
+
+#define CHANNEL_BATTERY 0 //AN0
+#define CHANNEL_TEMPERATURE 1 //AN1
+
+static volatile uint8_t done = 1; //Both readings are in
+static uint16_t battery;
+static uint16_t temperature;
+
+void adcSetup(){
+    //Set ANSELbit to disable digital input buffer
+    ANSELAbits.ANSA0=1;
+    ANSELAbits.ANSA1=1;
+
+    //Set TRISXbit to disable digital output driver
+    TRISAbits.RA0=1;
+    TRISAbits.RA1=1;
+
+    //Set voltage references
+    ADCON1bits.PVCFG=0; //A/D Vref+ connected to Vdd
+    ADCON1bits.NVCFG=0; //A/D Vref- connected to internal signal AVss
+    VREFCON0bits.FVRS=0b01; //Fixed voltage reference is 1.024V
+    VREFCON0bits.FVREN=1; //Enable internal reference
+
+    //Select channel 0 for A to D
+    ADCON0bits.CHS=CHANNEL_BATTERY;
+
+    //Set A to D acquisition time
+    ADCON2bits.ACQT=0b010; //Tacq = 4 Tad (4us)
+
+    //Set A to D clock period
+    ADCON2bits.ADCS=0b110; //Clock period set to Fosc/64 = 1us (64MHz clock)
+
+    //Set result format
+    ADCON2bits.ADFM = 1; //Data is mostly in the ADRESL register with 2 bits in the ADRESH register
+
+    //Turn on the A to D module
+    ADCON0bits.ADON=1;
+}
+
+/**
+ * Starts the battery conversion and returns straight away.  The temperature
+ * follows from adcInterrupt().
+ */
+void adcStart(){
+    done=0;
+    ADCON1bits.PVCFG=0b10; //A/D Vref+ connected to internal reference FVR BUF2
+    ADCON0bits.CHS=CHANNEL_BATTERY;
+    PIR1bits.ADIF=0;
+    PIE1bits.ADIE=1;
+    INTCONbits.PEIE=1;
+    HAL_ADC_START(); //The acquisition time comes first
+}
+
+/**
+ * Keeps the result of the conversion that has just finished and starts the
+ * next one, if there is one.
+ */
+void adcInterrupt(){
+    PIR1bits.ADIF=0;
+    uint16_t result = ADRESH * 256 + ADRESL; //Read A to D result
+    if(ADCON0bits.CHS == CHANNEL_BATTERY){
+        battery = result;
+        ADCON1bits.PVCFG=0; //A/D Vref+ connected to Vdd
+        ADCON0bits.CHS=CHANNEL_TEMPERATURE;
+        HAL_ADC_START();
+    }
+    else{
+        temperature = result;
+        PIE1bits.ADIE=0;
+        done=1;
+    }
+}
+
+void adcWait(){
+    HAL_ADC_WAIT(done);
+}
+
+uint16_t adcBattery(){
+    return battery;
+}
+
+uint16_t adcTemperature(){
+    return temperature;
+}
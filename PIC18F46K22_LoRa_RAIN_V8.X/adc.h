@@ -0,0 +1,33 @@
+/*
+ * File:   adc.h
+ * Author: Andy Page
+ * Comments: Battery and temperature readings, taken on the A to D in the
+ * background so the CPU can get on with the radio.  adcStart() starts the
+ * battery conversion (AN0 against the fixed voltage reference) and Isr()
+ * calls adcInterrupt() on ADIF, which keeps the result and starts the
+ * temperature (AN1, the NTC divider, against Vdd).  The second conversion
+ * ends the chain and adcWait() returns.  Each takes about 15us, the
+ * acquisition time (ACQT) included, so there is only time for a few SPI
+ * transfers alongside them; most of what measure() saves comes from a cold
+ * start of the radio covering the ADC_POWER_UP_MS the dividers need.
+ * GIE and the A to D clock (Fosc/64) must stay on until adcWait().
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_ADC_H
+#define	INC_ADC_H
+
+#include <stdint.h>
+
+#define ADC_POWER_UP_MS 5 //For the dividers to settle after configureIO() turns them on
+
+void adcSetup(void); //Pins, references and clock, once the A to D is powered (PMD2)
+void adcStart(void); //Battery then temperature, the dividers must have settled
+void adcInterrupt(void); //Called from Isr() on ADIF
+void adcWait(void); //Until both readings are in
+uint16_t adcBattery(void); //10 bit reading against FVR BUF2
+uint16_t adcTemperature(void); //10 bit reading against Vdd
+
+#endif	/* INC_ADC_H */
@@ -0,0 +1,55 @@
+/*
+ * File:   airtime.h
+ * Author: Andy Page
+ * Comments: LoRa time on air, worked out by the preprocessor/compiler so it
+ * costs nothing at run time.  Follows the SX1276 datasheet (section 4.1.1.7):
+ *
+ *   Tsym     = 2^SF / BW
+ *   Tpreamble = (preamble + 4.25) * Tsym
+ *   payload symbols = 8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH) / (4(SF - 2DE))) * (CR + 4), 0)
+ *
+ * SF is 6 to 12, BW in Hz, CR is 1 to 4 for 4/5 to 4/8, IH is 1 for implicit
+ * header, CRC is 1 when the payload CRC is on, DE is low data rate optimise,
+ * which must be on when a symbol is longer than 16ms.
+ * Times are in microseconds.  They are exact for 62.5k, 125k, 250k and 500k
+ * bandwidths, the narrower ones round the symbol time down to the microsecond.
+ * Only plain macros are used so the same header works in the firmware and in
+ * the host tools.
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_AIRTIME_H
+#define	INC_AIRTIME_H
+
+#define LORA_SYMBOL_US(sf, bw) ((1000000UL << (sf)) / (bw))
+#define LORA_LOW_DATA_RATE(sf, bw) (LORA_SYMBOL_US(sf, bw) > 16000UL ? 1 : 0)
+
+//Numerator and divisor of the ceil() in the payload symbol count
+#define LORA_PAYLOAD_BITS(sf, ih, crc, length) (8L * (length) - 4L * (sf) + 28 + 16L * (crc) - 20L * (ih))
+#define LORA_BITS_PER_BLOCK(sf, bw) (4L * ((sf) - 2 * LORA_LOW_DATA_RATE(sf, bw)))
+
+#define LORA_PAYLOAD_SYMBOLS(sf, bw, cr, ih, crc, length) \
+    (8UL + (LORA_PAYLOAD_BITS(sf, ih, crc, length) > 0 \
+        ? ((LORA_PAYLOAD_BITS(sf, ih, crc, length) + LORA_BITS_PER_BLOCK(sf, bw) - 1) \
+            / LORA_BITS_PER_BLOCK(sf, bw)) * ((cr) + 4) \
+        : 0UL))
+
+//Preamble is counted in quarter symbols for the extra 4.25
+#define LORA_PREAMBLE_US(sf, bw, preamble) ((4UL * (preamble) + 17) * LORA_SYMBOL_US(sf, bw) / 4)
+
+#define LORA_AIRTIME_US(sf, bw, cr, preamble, ih, crc, length) \
+    (LORA_PREAMBLE_US(sf, bw, preamble) + LORA_PAYLOAD_SYMBOLS(sf, bw, cr, ih, crc, length) * LORA_SYMBOL_US(sf, bw))
+
+/**
+ * Duty cycle budget.  dutyPermille is the regulatory limit in tenths of a
+ * percent, e.g. 10 for the 1% allowed in 865 to 868MHz (ETSI EN 300 220,
+ * ERC REC 70-03 band h1.4).
+ */
+#define LORA_BUDGET_US_PER_HOUR(dutyPermille) (3600000UL * (dutyPermille)) //ms of an hour * permille = us
+#define LORA_PACKETS_PER_HOUR(airtimeUs, dutyPermille) (LORA_BUDGET_US_PER_HOUR(dutyPermille) / (airtimeUs))
+//Shortest wait from the start of one packet to the start of the next
+#define LORA_MIN_SPACING_MS(airtimeUs, dutyPermille) (((airtimeUs) * 1000UL / (dutyPermille) + 999) / 1000)
+
+#endif	/* INC_AIRTIME_H */
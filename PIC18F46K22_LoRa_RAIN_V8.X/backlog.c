@@ -0,0 +1,280 @@
+/**
+ * backlog.c
+ * Readings that did not get through, kept in the data EEPROM, and the last
+ * few that did, see backlog.h
+ */
+
+#include <xc.h>
+#include "backlog.h"
+#include "log.h"
+
+#define STATE_QUEUED 0xB1 //Last byte of a whole entry, anything else is free
+#define STATE_FREE 0xFF
+
+static uint8_t queued = 0; //Entries in the EEPROM, so an empty backlog costs no reads
+static uint8_t nextSlot = 0; //Where the search for a free entry starts, which spreads the writes
+static uint8_t carried[BACKLOG_PER_PACKET]; //Entries in the last packet, oldest first
+static uint8_t carriedCount = 0;
+static uint8_t expired[BACKLOG_PER_PACKET]; //Entries backlogFill() found too old to send
+static uint8_t expiredCount = 0;
+
+typedef struct {
+    uint16_t message; //Low 16 bits of the counts
+    uint16_t tips;
+    uint32_t readings; //Battery and temperature, 10 bits each
+} Reading;
+
+static Reading history[BACKLOG_HISTORY]; //Readings sent, in order
+static uint8_t historyNext = 0; //Where the next goes, over the oldest
+static uint8_t historyCount = 0;
+
+static uint16_t entryAddress(uint8_t);
+static uint16_t age(uint8_t, uint32_t);
+static uint32_t packReadings(uint16_t, uint16_t);
+static uint8_t* pack(uint8_t*, uint16_t, uint16_t, uint32_t);
+static void expire(void);
+
+static uint16_t entryAddress(uint8_t slot){
+    return BACKLOG_START + (uint16_t)slot * BACKLOG_ENTRY;
+}
+
+/**
+ * How many messages ago a reading was taken.
+ * @param slot  Entry
+ * @param message  Message count now
+ * @return 0 for a free entry, otherwise at least 1, as a 0 in the packet
+ * ends the readings it carries
+ */
+static uint16_t age(uint8_t slot, uint32_t message){
+    uint16_t address = entryAddress(slot);
+    if(EEDataRead(address + BACKLOG_ENTRY - 1) != STATE_QUEUED){
+        return 0;
+    }
+    uint16_t then = (uint16_t)EEDataRead(address)<<8 | EEDataRead(address + 1);
+    uint16_t since = (uint16_t)message - then;
+    return since ? since : 1;
+}
+
+static uint32_t packReadings(uint16_t battery, uint16_t temperature){
+    return (uint32_t)(battery & BACKLOG_READING_MASK)<<BACKLOG_BATTERY_SHIFT | (temperature & BACKLOG_READING_MASK);
+}
+
+/**
+ * Packs one reading into a packet, see backlog.h.
+ * @param data  BACKLOG_PACKED bytes
+ * @param messagesSince  Messages since the reading, 1 to BACKLOG_MESSAGES_SINCE_MAX,
+ * never 0 which would end the readings
+ * @param tipsSince  Tips since the reading, up to BACKLOG_TIPS_SINCE_MAX
+ * @param readings  Battery and temperature from packReadings()
+ * @return Where the next one goes
+ */
+static uint8_t* pack(uint8_t* data, uint16_t messagesSince, uint16_t tipsSince, uint32_t readings){
+    uint32_t packed = (uint32_t)tipsSince<<BACKLOG_TIPS_SHIFT | readings;
+    data[0] = (uint8_t)messagesSince;
+    data[1] = (uint8_t)((packed>>24)&0xFF); //MSB
+    data[2] = (uint8_t)((packed>>16)&0xFF);
+    data[3] = (uint8_t)((packed>>8)&0xFF);
+    data[4] = (uint8_t)(packed & 0xFF); //LSB
+    return data + BACKLOG_PACKED;
+}
+
+/**
+ * Frees the entries the last backlogFill() aged out.  Writes a byte for each.
+ */
+static void expire(){
+    static const uint8_t freed = STATE_FREE;
+    if(!expiredCount){
+        return;
+    }
+    for(uint8_t i=0;i<expiredCount;i++){
+        EEDataWrite(entryAddress(expired[i]) + BACKLOG_ENTRY - 1, &freed, 1);
+        queued--;
+    }
+    LOG_EVENT(EV_AGED_OUT, expiredCount);
+    expiredCount = 0;
+}
+
+/**
+ * Counts the entries left in the EEPROM before a reset.  A blank EEPROM has
+ * none.
+ * @return Readings queued
+ */
+uint8_t backlogInit(){
+    queued = 0;
+    carriedCount = 0;
+    expiredCount = 0;
+    for(uint8_t slot=0;slot<BACKLOG_ENTRIES;slot++){
+        if(EEDataRead(entryAddress(slot) + BACKLOG_ENTRY - 1) == STATE_QUEUED){
+            queued++;
+        }
+    }
+    return queued;
+}
+
+uint8_t backlogCount(){
+    return queued;
+}
+
+/**
+ * Queues a reading in the next free entry, or over the oldest if there is
+ * none.  Writes up to 9 bytes, so call it on the slow clock (clockIdle()).
+ * @param message  Message count of the packet that did not get through
+ * @param tips  Tip count in it
+ * @param battery  Battery A to D reading
+ * @param temperature  Temperature A to D reading
+ */
+void backlogAdd(uint32_t message, uint32_t tips, uint16_t battery, uint16_t temperature){
+    static const uint8_t freed = STATE_FREE;
+    expire(); //Makes room first
+    uint8_t slot = nextSlot;
+    uint8_t oldest = nextSlot;
+    uint16_t oldestAge = 0;
+    for(uint8_t i=0;i<BACKLOG_ENTRIES;i++){
+        uint16_t entryAge = age(slot, message);
+        if(!entryAge){
+            break;
+        }
+        if(entryAge > oldestAge){
+            oldest = slot;
+            oldestAge = entryAge;
+        }
+        if(++slot == BACKLOG_ENTRIES){
+            slot = 0;
+        }
+    }
+    if(oldestAge && slot == nextSlot){ //Full, the search went all the way round
+        slot = oldest;
+        EEDataWrite(entryAddress(slot) + BACKLOG_ENTRY - 1, &freed, 1); //Not used if the power goes part way
+    }
+    else{
+        queued++;
+    }
+
+    uint32_t readings = packReadings(battery, temperature);
+    uint8_t entry[BACKLOG_ENTRY];
+    entry[0] = (uint8_t)((message>>8)&0xFF);
+    entry[1] = (uint8_t)(message & 0xFF);
+    entry[2] = (uint8_t)((tips>>8)&0xFF);
+    entry[3] = (uint8_t)(tips & 0xFF);
+    entry[4] = (uint8_t)((readings>>16)&0xFF);
+    entry[5] = (uint8_t)((readings>>8)&0xFF);
+    entry[6] = (uint8_t)(readings & 0xFF);
+    entry[7] = STATE_QUEUED; //Last
+    EEDataWrite(entryAddress(slot), entry, BACKLOG_ENTRY);
+    nextSlot = slot + 1;
+    if(nextSlot == BACKLOG_ENTRIES){
+        nextSlot = 0;
+    }
+    carriedCount = 0; //Whatever the failed packet carried is still queued
+}
+
+/**
+ * Adds a reading to the history once a packet has taken it.
+ * @param message  Message count of the packet
+ * @param tips  Tip count in it
+ * @param battery  Battery A to D reading
+ * @param temperature  Temperature A to D reading
+ */
+void backlogRemember(uint32_t message, uint32_t tips, uint16_t battery, uint16_t temperature){
+    history[historyNext].message = (uint16_t)message;
+    history[historyNext].tips = (uint16_t)tips;
+    history[historyNext].readings = packReadings(battery, temperature);
+    if(++historyNext == BACKLOG_HISTORY){
+        historyNext = 0;
+    }
+    if(historyCount < BACKLOG_HISTORY){
+        historyCount++;
+    }
+}
+
+/**
+ * Packs the oldest readings from the backlog into the data area of a packet,
+ * then the newest from the history, then zeros.  Reads nothing from the
+ * EEPROM when the backlog is empty.  A queued reading too old for the counts
+ * is left out, and freed with the ones that went.
+ * @param data  slots * BACKLOG_PACKED bytes
+ * @param slots  Readings that fit, up to BACKLOG_PER_PACKET
+ * @param message  Message count of the packet
+ * @param tips  Tip count in the packet
+ * @return Readings packed from the backlog
+ */
+uint8_t backlogFill(uint8_t* data, uint8_t slots, uint32_t message, uint32_t tips){
+    uint16_t ages[BACKLOG_PER_PACKET];
+    uint8_t* end = data + slots * BACKLOG_PACKED;
+    uint8_t chosen;
+    carriedCount = 0;
+    expiredCount = 0;
+
+    for(uint8_t slot=0;queued && slot<BACKLOG_ENTRIES;slot++){
+        uint16_t entryAge = age(slot, message);
+        if(!entryAge){
+            continue;
+        }
+        uint8_t i = carriedCount; //Insert it in order, oldest first
+        if(i == slots){
+            if(entryAge <= ages[i-1]){
+                continue;
+            }
+            i--;
+        }
+        else{
+            carriedCount++;
+        }
+        while(i && ages[i-1] < entryAge){
+            ages[i] = ages[i-1];
+            carried[i] = carried[i-1];
+            i--;
+        }
+        ages[i] = entryAge;
+        carried[i] = slot;
+    }
+
+    //The oldest come first, so any too old are at the start
+    chosen = carriedCount;
+    carriedCount = 0;
+    for(uint8_t i=0;i<chosen;i++){
+        uint16_t address = entryAddress(carried[i]);
+        uint16_t tipsThen = (uint16_t)EEDataRead(address + 2)<<8 | EEDataRead(address + 3);
+        uint16_t tipsSince = (uint16_t)tips - tipsThen;
+        if(ages[i] > BACKLOG_MESSAGES_SINCE_MAX || tipsSince > BACKLOG_TIPS_SINCE_MAX){
+            expired[expiredCount++] = carried[i];
+            continue;
+        }
+        uint32_t readings = (uint32_t)(EEDataRead(address + 4) & 0x0F)<<16
+                | (uint32_t)EEDataRead(address + 5)<<8 | EEDataRead(address + 6);
+        carried[carriedCount++] = carried[i];
+        data = pack(data, ages[i], tipsSince, readings);
+    }
+
+    //Then the history, newest first, while the message count still dates them
+    uint8_t i = historyNext;
+    for(uint8_t n=0;n<historyCount && data<end;n++){
+        i = i ? i - 1 : BACKLOG_HISTORY - 1;
+        uint16_t since = (uint16_t)message - history[i].message;
+        uint16_t tipsSince = (uint16_t)tips - history[i].tips;
+        if(since == 0 || since > BACKLOG_MESSAGES_SINCE_MAX || tipsSince > BACKLOG_TIPS_SINCE_MAX){
+            break; //Older ones are further out still
+        }
+        data = pack(data, since, tipsSince, history[i].readings);
+    }
+
+    while(data < end){
+        *data++ = 0;
+    }
+    return carriedCount;
+}
+
+/**
+ * Frees the entries the last backlogFill() packed, once the packet has gone,
+ * and any it aged out.  Writes a byte for each, so call it on the slow clock
+ * (clockIdle()).
+ */
+void backlogSent(){
+    static const uint8_t freed = STATE_FREE;
+    for(uint8_t i=0;i<carriedCount;i++){
+        EEDataWrite(entryAddress(carried[i]) + BACKLOG_ENTRY - 1, &freed, 1);
+        queued--;
+    }
+    carriedCount = 0;
+    expire();
+}
@@ -0,0 +1,66 @@
+/*
+ * File:   backlog.h
+ * Author: Andy Page
+ * Comments: Readings that did not get through, kept in the data EEPROM after
+ * the journal (journal.h) until a packet carries them, and a history of the
+ * last few that did, so a gateway that misses a packet can fill the gap from
+ * the next one.
+ * A reading is queued when its packet times out, and below UVLO, where the
+ * short packet has no temperature.  The next full packet carries up to
+ * BACKLOG_PER_PACKET of the oldest in the data area (bytes 28 to 47) and they
+ * are dropped once its TxDone comes.  There is no clock that keeps time in
+ * sleep, so a reading is dated by the message count, which goes up once a
+ * report, and its tips are given as how many came after it.
+ * Any slots the backlog does not fill carry the last BACKLOG_HISTORY readings
+ * that were sent, newest first, in the same form.  The history is only in RAM,
+ * it starts again after a reset.  A gateway that sees the same message count
+ * twice has the same reading twice.
+ * Each is BACKLOG_PACKED bytes in the packet, packed MSB first, messages
+ * since in the first byte and the rest in 32 bits (the BACKLOG_*_SHIFTs):
+ *  8 bits  messages since, 1 to 254 (0 is an empty entry)
+ * 12 bits  tips since, up to 4094
+ * 10 bits  battery A to D reading
+ * 10 bits  temperature A to D reading
+ * All ones in either count is never sent, a gateway skips it, and messages
+ * since is never 0 for a reading, so the first 0 ends them.  A queued reading
+ * that has got too old for the counts is aged out and lost (EV_AGED_OUT), the
+ * history just stops short.
+ * In the EEPROM each takes BACKLOG_ENTRY bytes: the low 16 bits of the
+ * message and tip counts, the two readings in 20 bits, then a state byte that
+ * is written last, so one cut short by a power failure is not used.  When the
+ * backlog is full the oldest reading makes way.
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_BACKLOG_H
+#define	INC_BACKLOG_H
+
+#include <stdint.h>
+#include "eedata.h"
+#include "journal.h"
+
+#define BACKLOG_START JOURNAL_SIZE
+#define BACKLOG_ENTRY 8 //Bytes in the EEPROM
+#define BACKLOG_ENTRIES ((EEDATA_SIZE - BACKLOG_START) / BACKLOG_ENTRY)
+#define BACKLOG_PACKED 5 //Bytes in a packet
+#define BACKLOG_TIPS_SHIFT 20 //In the 32 bits after messages since
+#define BACKLOG_BATTERY_SHIFT 10 //Temperature is in the low 10 bits
+#define BACKLOG_READING_MASK 0x3FF //Battery or temperature
+#define BACKLOG_PER_PACKET 4 //Fills bytes 28 to 47 of the full packet, the most backlogFill() takes
+#define BACKLOG_DRAIN_PACKETS 1 //Extra packets after a report to drain the backlog
+#define BACKLOG_HISTORY BACKLOG_PER_PACKET //Readings sent, kept to go again
+#define BACKLOG_MESSAGES_SATURATED 0xFF //All ones, never sent
+#define BACKLOG_TIPS_SATURATED 0xFFF
+#define BACKLOG_MESSAGES_SINCE_MAX (BACKLOG_MESSAGES_SATURATED - 1)
+#define BACKLOG_TIPS_SINCE_MAX (BACKLOG_TIPS_SATURATED - 1)
+
+uint8_t backlogInit(void); //Scans the EEPROM after a reset, returns how many are queued
+uint8_t backlogCount(void);
+void backlogAdd(uint32_t, uint32_t, uint16_t, uint16_t); //Message count, tips, battery, temperature
+void backlogRemember(uint32_t, uint32_t, uint16_t, uint16_t); //A reading that went: message count, tips, battery, temperature
+uint8_t backlogFill(uint8_t*, uint8_t, uint32_t, uint32_t); //Packet data area, slots, message count, tips, returns how many from the backlog
+void backlogSent(void); //Drops the ones backlogFill() put in the packet, and any it aged out
+
+#endif	/* INC_BACKLOG_H */
@@ -0,0 +1,151 @@
+/**
+ * clock.c
+ * Slow clock, Timer1 tick and Timer3 delays, see clock.h
+ */
+
+#include <xc.h>
+#include "clock.h"
+#include "usart2.h"
+#include "hal.h"
+
+#define TICK_RELOAD (65536UL - TICK_COUNTS)
+
+static void slowClock(void);
+static void fastClock(void);
+
+/**
+ * Switches the CPU to LFINTOSC in idle mode and stops the crystal.
+ */
+static void slowClock(){
+    OSCTUNEbits.INTSRC=0; //31kHz from LFINTOSC rather than HFINTOSC
+    OSCCONbits.IRCF=0; //31kHz
+    OSCCONbits.IDLEN=1; //SLEEP() idles the CPU, peripherals keep their clock
+    OSCCONbits.SCS=0b10; //Internal oscillator block
+    HAL_CLOCK_WAIT_INTERNAL();
+    OSCCON2bits.PRISD=0; //Stop the crystal
+}
+
+/**
+ * Switches back to the crystal, returning once the PLL is locked so SPI and
+ * UART timings are right again.
+ */
+static void fastClock(){
+    OSCCONbits.IDLEN=0; //SLEEP() is a full sleep again
+    OSCCON2bits.PRISD=1; //Start the crystal
+    OSCCONbits.SCS=0; //Primary clock (HSMP and PLL from the configuration bits)
+    HAL_CLOCK_WAIT_PRIMARY();
+}
+
+/**
+ * Switches the CPU to LFINTOSC in idle mode and starts Timer1 ticking.
+ * Interrupts must be enabled (GIE) for the tick to reach Isr().
+ */
+void clockSlow(){
+    slowClock();
+    PMD0bits.TMR1MD=0; //Turn on timer 1
+    T1CON=0; //Fosc/4, no prescale, stopped
+    TMR1H=(uint8_t)(TICK_RELOAD>>8);
+    TMR1L=(uint8_t)(TICK_RELOAD & 0xFF);
+    PIR1bits.TMR1IF=0;
+    PIE1bits.TMR1IE=1;
+    INTCONbits.PEIE=1;
+    T1CONbits.TMR1ON=1;
+}
+
+/**
+ * Stops the tick and switches back to the crystal.
+ */
+void clockFast(){
+    T1CONbits.TMR1ON=0;
+    PIE1bits.TMR1IE=0;
+    PIR1bits.TMR1IF=0;
+    PMD0bits.TMR1MD=1; //Turn off timer 1
+    fastClock();
+}
+
+/**
+ * Reloads Timer1 for the next tick and clears its flag.  Timer1 keeps
+ * counting after the overflow, so the few counts it has made since are kept.
+ */
+void clockTick(){
+    T1CONbits.TMR1ON=0; //Stopped so TMR1H cannot change between the two reads
+    uint16_t count = TMR1L;
+    count += (uint16_t)TMR1H << 8;
+    count += (uint16_t)TICK_RELOAD;
+    TMR1H=(uint8_t)(count>>8);
+    TMR1L=(uint8_t)(count & 0xFF);
+    T1CONbits.TMR1ON=1;
+    PIR1bits.TMR1IF=0;
+}
+
+/**
+ * Switches the CPU to LFINTOSC in idle mode with nothing timing it, for waits
+ * that end with an interrupt flag, such as a data EEPROM write (EEIF).  The
+ * log output is sent first as USART2 is clocked from Fosc.
+ */
+void clockIdle(){
+    USART2_Flush();
+    slowClock();
+}
+
+/**
+ * Switches back to the crystal after clockIdle().
+ */
+void clockRun(){
+    fastClock();
+}
+
+/**
+ * Waits up to ms milliseconds (up to CLOCK_SLEEP_MAX_MS) with the CPU idle on
+ * LFINTOSC, as clockSleepMs(), and returns early once Isr() has set done.
+ * For waits on something that may never come.  Interrupts must be on.
+ * @param ms  Longest wait
+ * @param done  Set by Isr() when what is being waited for has happened
+ * @return done, 0 if the time ran out first
+ */
+uint8_t clockSleepUntil(uint16_t ms, volatile uint8_t *done){
+    uint16_t reload = (uint16_t)(65536UL - ((uint32_t)ms * CLOCK_SLOW_MAX_HZ + 3999) / 4000); //Fosc/4, LFINTOSC at its fastest
+    uint8_t interrupts = INTCONbits.GIE;
+    USART2_Flush();
+    INTCONbits.GIE=0; //Isr() only runs between the idles below
+    slowClock();
+    PMD0bits.TMR3MD=0; //Turn on timer 3
+    T3CON=0; //Fosc/4, no prescale, stopped
+    TMR3H=(uint8_t)(reload>>8);
+    TMR3L=(uint8_t)(reload & 0xFF);
+    PIR2bits.TMR3IF=0;
+    PIE2bits.TMR3IE=1; //Wakes the CPU, and Isr() turns it off again
+    INTCONbits.PEIE=1;
+    T3CONbits.TMR3ON=1;
+    while(!PIR2bits.TMR3IF && !*done){
+        SLEEP(); //Idle until Timer3, a tip or whatever sets done
+        if(interrupts){
+            HAL_INTERRUPTS_ON(); //Isr() counts the tip
+            INTCONbits.GIE=0;
+        }
+    }
+    T3CONbits.TMR3ON=0;
+    PIE2bits.TMR3IE=0;
+    PIR2bits.TMR3IF=0;
+    PMD0bits.TMR3MD=1; //Turn off timer 3
+    fastClock();
+    if(interrupts){
+        HAL_INTERRUPTS_ON();
+    }
+    return *done;
+}
+
+#if CLOCK_SLEEP_DELAYS
+/**
+ * Waits at least ms milliseconds (up to CLOCK_SLEEP_MAX_MS) with the CPU idle
+ * on LFINTOSC and the crystal stopped, timed by Timer3.  The clock switch
+ * back adds about 2ms.  Nothing clocked from Fosc (SPI2, USART2) can be in
+ * use, so the log output is sent first.  Tips are still counted if
+ * interrupts were on.
+ * @param ms  Time to wait
+ */
+void clockSleepMs(uint16_t ms){
+    static volatile uint8_t never = 0;
+    clockSleepUntil(ms, &never);
+}
+#endif
@@ -0,0 +1,51 @@
+/*
+ * File:   clock.h
+ * Author: Andy Page
+ * Comments: Slow clock for timing things while the PIC waits.
+ * Nothing on this board keeps time in sleep apart from the watchdog, which is
+ * fixed at 128 seconds and cleared by every SLEEP.  For shorter waits the CPU
+ * is switched from the 64MHz crystal and PLL to LFINTOSC (31kHz) with IDLEN
+ * set, so SLEEP() idles the CPU but leaves Timer1 running from Fosc/4.  Timer1
+ * then interrupts every TICK_MS and Isr() calls clockTick().  The crystal is
+ * stopped while on the slow clock (PRICLKEN is off in config.h so PRISD can
+ * do this) and clockFast() waits for it and the PLL to start again.
+ * clockSleepMs() uses the same slow clock with Timer3 in place of the
+ * __delay_ms() busy waits, which keep the CPU running at 11.5mA.  The
+ * watchdog cannot time these as its period is fixed by the WDTPS
+ * configuration bits.
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_CLOCK_H
+#define	INC_CLOCK_H
+
+#include <stdint.h>
+
+#define CLOCK_SLOW_HZ 31000UL //LFINTOSC, +/-15% over temperature and supply
+#define CLOCK_SLOW_MAX_HZ 35650UL //For waits that must not be short
+#define CLOCK_SLEEP_MAX_MS (65535UL * 4000 / CLOCK_SLOW_MAX_HZ)
+
+#ifndef CLOCK_SLEEP_DELAYS
+#define CLOCK_SLEEP_DELAYS 1 //0 makes clockSleepMs() a __delay_ms() busy wait, for comparison
+#endif
+#define TICK_MS 100
+#define TICK_COUNTS (CLOCK_SLOW_HZ / 4 * TICK_MS / 1000) //Timer1 counts per tick at Fosc/4
+#if TICK_COUNTS > 65535
+#error "TICK_MS is too long for Timer1"
+#endif
+
+void clockSlow(void); //Run from LFINTOSC and start the tick
+void clockFast(void); //Stop the tick and go back to the crystal and PLL
+void clockTick(void); //Restarts Timer1 for the next tick, called from Isr() on TMR1IF
+void clockIdle(void); //Run from LFINTOSC without the tick, SLEEP() idles until an interrupt flag
+void clockRun(void); //Back to the crystal and PLL after clockIdle()
+#if CLOCK_SLEEP_DELAYS
+void clockSleepMs(uint16_t ms); //Idle for at least ms on the slow clock
+#else
+#define clockSleepMs(ms) __delay_ms(ms)
+#endif
+uint8_t clockSleepUntil(uint16_t ms, volatile uint8_t *done); //As clockSleepMs(), ending early once Isr() sets done
+
+#endif	/* INC_CLOCK_H */
@@ -0,0 +1,99 @@
+/**
+ * compact.c
+ * Makes up packets in the compact format, see compact.h
+ */
+
+#include <stdint.h>
+#include "compact.h"
+#include "CRC16.h"
+
+static uint8_t* varint(uint8_t*, uint32_t);
+
+/**
+ * Writes a count 7 bits at a time, least significant first.
+ * @return Where the next field goes
+ */
+static uint8_t* varint(uint8_t* data, uint32_t value){
+    while(value > 0x7F){
+        *data++ = (uint8_t)(value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    *data++ = (uint8_t)value;
+    return data;
+}
+
+/**
+ * Hash that stands in for the ID and address, so a gateway can tell its
+ * gauges apart in 2 bytes rather than 10.
+ * @param id0  ID0 of the common format
+ * @param id1  ID1
+ * @param address  8 byte address
+ */
+uint16_t compactAddressHash(uint8_t id0, uint8_t id1, const uint8_t* address){
+    uint8_t id[10];
+    id[0] = id0;
+    id[1] = id1;
+    for(uint8_t i=0;i<8;i++){
+        id[i+2] = address[i];
+    }
+    return CRC16(id, sizeof(id));
+}
+
+/**
+ * Makes up a compact packet.
+ * @param packet  COMPACT_MAX_LENGTH bytes
+ * @param addressHash  From compactAddressHash()
+ * @param message  Message count
+ * @param tips  Tip count
+ * @param battery  Battery A to D reading
+ * @param temperature  Temperature A to D reading, COMPACT_NO_TEMPERATURE to leave it out
+ * @param histogram  COMPACT_HISTOGRAM_BYTES of tip histogram, 0 to leave it out
+ * @param carried  Readings packed by backlogFill(), stopping at the first empty one
+ * @param slots  Most readings to take from carried, up to 7
+ * @return Packet length, with the CRC16 if PACKET_CRC has PACKET_CRC_SOFTWARE
+ */
+uint8_t compactPacket(uint8_t* packet, uint16_t addressHash, uint32_t message, uint32_t tips,
+                      uint16_t battery, uint16_t temperature, const uint8_t* histogram,
+                      const uint8_t* carried, uint8_t slots){
+    uint8_t header = COMPACT_FORMAT;
+    uint8_t* data = packet + 1;
+    *data++ = (uint8_t)(addressHash >> 8); //MSB
+    *data++ = (uint8_t)(addressHash & 0xFF); //LSB
+    data = varint(data, message);
+    data = varint(data, tips);
+    if(temperature != COMPACT_NO_TEMPERATURE){
+        header |= COMPACT_TEMPERATURE;
+        uint32_t readings = (uint32_t)(battery & BACKLOG_READING_MASK)<<BACKLOG_BATTERY_SHIFT
+                | (temperature & BACKLOG_READING_MASK);
+        *data++ = (uint8_t)((readings>>16)&0xFF); //MSB
+        *data++ = (uint8_t)((readings>>8)&0xFF);
+        *data++ = (uint8_t)(readings & 0xFF); //LSB
+    }
+    else{
+        *data++ = (uint8_t)((battery>>8)&0xFF); //MSB
+        *data++ = (uint8_t)(battery & 0xFF); //LSB
+    }
+    if(histogram){
+        header |= COMPACT_HISTOGRAM;
+        for(uint8_t i=0;i<COMPACT_HISTOGRAM_BYTES;i++){
+            *data++ = histogram[i];
+        }
+    }
+    uint8_t count = 0;
+    while(count < slots && carried[0]){ //Messages since is never 0 in a reading
+        for(uint8_t i=0;i<BACKLOG_PACKED;i++){
+            *data++ = *carried++;
+        }
+        count++;
+    }
+    packet[0] = header | (uint8_t)(count << COMPACT_CARRIED_SHIFT);
+
+    uint8_t length = (uint8_t)(data - packet);
+#if PACKET_CRC & PACKET_CRC_SOFTWARE
+    unsigned short int calcCRC = CRC16(packet, length);
+    *data++ = (calcCRC&0xFF); //LSB
+    *data++ = (calcCRC&0xFF00u)>>8u; //MSB
+    length += 2;
+#endif
+    return length;
+}
@@ -0,0 +1,52 @@
+/*
+ * File:   compact.h
+ * Author: Andy Page
+ * Comments: Compact packet format, for gateways that understand it, in place
+ * of the common 50 byte one (PACKET_COMPACT in main.c).  Fields that are not
+ * needed are left out and the counts are varints, so a report is 13 to 22
+ * bytes and has about half the time on air.
+ * There is no length byte as the LoRa header has the length.  The first byte
+ * is 0xA0 to 0xBF, which tells it from the common format, where the first
+ * byte is the length (50 or 24).
+ *  1 byte   header: COMPACT_FORMAT, readings carried (bits 4 to 2),
+ *           COMPACT_HISTOGRAM and COMPACT_TEMPERATURE
+ *  2 bytes  address hash, CRC16 of ID0, ID1 and the 8 byte address, MSB first
+ *  varint   message count
+ *  varint   tip count
+ *  3 bytes  battery and temperature, 10 bits each, MSB first, or the battery
+ *           alone in 2 bytes without COMPACT_TEMPERATURE
+ *  4 bytes  tip histogram, as in bytes 20 to 23 of the common format, if
+ *           COMPACT_HISTOGRAM
+ *  5 bytes  for each reading carried, as in backlog.h
+ *  2 bytes  CRC16 of the rest, LSB first as in the common format, left off
+ *           as there when PACKET_CRC (defines.h) leaves it to the radio
+ * A varint is 7 bits a byte, least significant first, with the top bit set
+ * in all but the last byte, so a count under 16384 takes 2 bytes.
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_COMPACT_H
+#define	INC_COMPACT_H
+
+#include <stdint.h>
+#include "backlog.h"
+#include "defines.h"
+
+#define COMPACT_FORMAT 0xA0 //Top 3 bits of the header, the next version will be 0xC0
+#define COMPACT_FORMAT_MASK 0xE0
+#define COMPACT_CARRIED_SHIFT 2
+#define COMPACT_CARRIED_MASK 0x1C
+#define COMPACT_HISTOGRAM 0x02
+#define COMPACT_TEMPERATURE 0x01
+#define COMPACT_NO_TEMPERATURE 0xFFFF
+#define COMPACT_HISTOGRAM_BYTES 4
+#define COMPACT_CARRIED 1 //Readings from the backlog or the history in each packet
+#define COMPACT_CRC16_BYTES ((PACKET_CRC & PACKET_CRC_SOFTWARE) ? 2 : 0)
+#define COMPACT_MAX_LENGTH (1 + 2 + 5 + 5 + 3 + COMPACT_HISTOGRAM_BYTES + COMPACT_CARRIED * BACKLOG_PACKED + COMPACT_CRC16_BYTES)
+
+uint16_t compactAddressHash(uint8_t, uint8_t, const uint8_t*); //ID0, ID1, 8 byte address
+uint8_t compactPacket(uint8_t*, uint16_t, uint32_t, uint32_t, uint16_t, uint16_t, const uint8_t*, const uint8_t*, uint8_t);
+
+#endif	/* INC_COMPACT_H */
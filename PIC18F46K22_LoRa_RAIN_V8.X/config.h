@@ -15,7 +15,7 @@
 // CONFIG1H
 #pragma config FOSC = HSMP        // Oscillator Selection bits (High speed crystal oscillator)
 #pragma config PLLCFG = ON      // 4X PLL Enable (Oscillator multiplied by 4)
-#pragma config PRICLKEN = ON    // Primary clock enable bit (Primary clock is always enabled)
+#pragma config PRICLKEN = OFF   // Primary clock enable bit (Primary clock can be disabled by software, see clock.c)
 #pragma config FCMEN = OFF      // Fail-Safe Clock Monitor Enable bit (Fail-Safe Clock Monitor disabled)
 #pragma config IESO = OFF       // Internal/External Oscillator Switchover bit (Oscillator Switchover mode disabled)
 
@@ -12,5 +12,15 @@
 #define GREEN_LED LATEbits.LATE1 //Green LED output port
 #define RED_LED LATEbits.LATE2 //Red LED output port
 
+//What checks a packet got through whole, see packet.h.  The radio's own
+//payload CRC is on air but costs no CPU time, the CRC16 is in the payload
+//and works with any receiver.
+#define PACKET_CRC_SOFTWARE 1 //CRC16() in the last 2 bytes of the payload
+#define PACKET_CRC_RADIO 2 //The SX1276 payload CRC, RxPayloadCrcOn in RegModemConfig2
+#define PACKET_CRC_BOTH (PACKET_CRC_SOFTWARE | PACKET_CRC_RADIO)
+#ifndef PACKET_CRC
+#define PACKET_CRC PACKET_CRC_SOFTWARE
+#endif
+
 
 #endif	/* INC_DEFINES_H */
\ No newline at end of file
@@ -0,0 +1,56 @@
+/**
+ * eedata.c
+ * Data EEPROM reads and writes, see eedata.h
+ */
+
+#include <xc.h>
+#include "eedata.h"
+#include "hal.h"
+
+/**
+ * Reads one byte of data EEPROM.
+ * @param address  0 to 1023
+ */
+uint8_t EEDataRead(uint16_t address){
+    EEADRH = (uint8_t)(address >> 8);
+    EEADR = (uint8_t)(address & 0xFF);
+    EECON1bits.EEPGD = 0; //Data EEPROM rather than program memory
+    EECON1bits.CFGS = 0;
+    HAL_EEPROM_READ();
+    return EEDATA;
+}
+
+/**
+ * Writes bytes to the data EEPROM in order, skipping any that already hold
+ * the value.  Interrupts are off for each unlock sequence and the write it
+ * starts, so Isr() only runs in between, and EEIE is on to end the idle.
+ * @param address  Of the first byte
+ * @param data  Values to write
+ * @param length  Number of bytes
+ */
+void EEDataWrite(uint16_t address, const uint8_t* data, uint8_t length){
+    uint8_t interrupts = INTCONbits.GIE;
+    INTCONbits.GIE=0;
+    PIE2bits.EEIE=1; //Ends the idle at the end of each write
+    INTCONbits.PEIE=1;
+    for(uint8_t i=0;i<length;i++){
+        if(EEDataRead(address + i) == data[i]){
+            continue;
+        }
+        EEDATA = data[i];
+        EECON1bits.WREN = 1;
+        PIR2bits.EEIF = 0;
+        HAL_EEPROM_WRITE();
+        EECON1bits.WREN = 0; //Does not stop the write that has started
+        HAL_EEPROM_WAIT();
+        PIR2bits.EEIF = 0;
+        if(interrupts){
+            HAL_INTERRUPTS_ON(); //Isr() counts any tips
+            INTCONbits.GIE=0;
+        }
+    }
+    PIE2bits.EEIE=0; //Isr() does not handle it
+    if(interrupts){
+        HAL_INTERRUPTS_ON();
+    }
+}
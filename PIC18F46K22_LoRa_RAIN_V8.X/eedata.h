@@ -0,0 +1,26 @@
+/*
+ * File:   eedata.h
+ * Author: Andy Page
+ * Comments: Byte access to the 1KB data EEPROM, shared by the journal of
+ * counts (journal.c, the first JOURNAL_SIZE bytes) and the backlog of
+ * readings that did not get through (backlog.c, the rest).
+ * Bytes that already hold the value are not written again, which saves a
+ * cycle of the cell's endurance.  Each write takes about 4ms and the CPU
+ * idles in SLEEP() until the EEIF interrupt flag ends it, so call
+ * EEDataWrite() on the slow clock (clockIdle()).
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_EEDATA_H
+#define	INC_EEDATA_H
+
+#include <stdint.h>
+
+#define EEDATA_SIZE 1024
+
+uint8_t EEDataRead(uint16_t); //Address
+void EEDataWrite(uint16_t, const uint8_t*, uint8_t); //Address, data, length
+
+#endif	/* INC_EEDATA_H */
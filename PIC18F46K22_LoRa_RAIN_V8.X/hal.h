@@ -0,0 +1,93 @@
+/*
+ * File:   hal.h
+ * Author: Andy Page
+ * Comments: Hardware abstraction for the places where the firmware waits on a
+ * peripheral (SPI2 transfers, A to D conversions, USART2 transmit, clock
+ * switches, data EEPROM).
+ * On the PIC these are plain SFR accesses so there is no cost.  When built with
+ * HOST_BUILD defined (see host/Makefile) they call into the host simulator
+ * instead, so the same main loop and LoRa driver can run on a PC.
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_HAL_H
+#define	INC_HAL_H
+
+#include <xc.h>
+#include <stdint.h>
+
+#ifdef HOST_BUILD
+
+#define HAL_SPI2_SELECT() hostSPI2Select() //SS low
+#define HAL_SPI2_DESELECT() hostSPI2Deselect() //SS high
+#define HAL_SPI2_TRANSFER(tx, rx) (rx) = hostSPI2Transfer(tx)
+#define HAL_SPI2_WRITE(tx) (void)hostSPI2Transfer(tx)
+#define HAL_ADC_START() hostADCStart()
+#define HAL_ADC_WAIT(done) while(!(done)){ hostADCWait(); }
+#define HAL_UART2_TX_IDLE() hostUART2TxIdle()
+#define HAL_UART2_TX_READY() hostUART2TxReady()
+#define HAL_UART2_WRITE(c) hostUART2Write(c)
+#define HAL_CLOCK_WAIT_INTERNAL() hostClockInternal()
+#define HAL_CLOCK_WAIT_PRIMARY() hostClockPrimary()
+#define HAL_INTERRUPTS_ON() hostInterruptsOn()
+#define HAL_EEPROM_READ() hostEepromRead()
+#define HAL_EEPROM_WRITE() hostEepromWrite()
+#define HAL_EEPROM_WAIT() hostEepromWait()
+
+#else
+
+#define HAL_SPI2_SELECT() LATDbits.LATD3=0 //SS low
+#define HAL_SPI2_DESELECT() LATDbits.LATD3=1 //SS high
+
+//Sends tx on SPI2 and waits for the byte clocked in at the same time
+#define HAL_SPI2_TRANSFER(tx, rx) do{ \
+    SSP2IF=0; \
+    SSP2BUF=(tx); \
+    while(!SSP2IF){} \
+    SSP2IF=0; \
+    (rx)=SSP2BUF; \
+}while(0)
+
+//Sends tx on SPI2, and reads SSP2BUF only to clear BF
+#define HAL_SPI2_WRITE(tx) do{ \
+    SSP2IF=0; \
+    SSP2BUF=(tx); \
+    while(!SSP2IF){} \
+    SSP2IF=0; \
+    (void)SSP2BUF; \
+}while(0)
+
+//Starts a conversion on the selected channel, ADIF is set when it is done
+//(about 15us)
+#define HAL_ADC_START() ADCON0bits.GO_NOT_DONE=1
+//Until Isr() sets done
+#define HAL_ADC_WAIT(done) while(!(done)){}
+
+#define HAL_UART2_TX_IDLE() (TRMT2) //Shift register empty, last byte has gone
+#define HAL_UART2_TX_READY() (PIR3bits.TX2IF) //TXREG2 empty
+#define HAL_UART2_WRITE(c) TXREG2=(c)
+
+//Clock switches (SCS) take effect once the new clock is running
+#define HAL_CLOCK_WAIT_INTERNAL() while(OSCCONbits.OSTS){}
+#define HAL_CLOCK_WAIT_PRIMARY() while(!OSCCONbits.OSTS || !OSCCON2bits.PLLRDY){} //Oscillator start-up timer, then PLL lock
+
+//GIE on again after a section that had it off.  Anything pending goes to Isr()
+//before the next instruction, which the simulator has to be told about.
+#define HAL_INTERRUPTS_ON() INTCONbits.GIE=1
+
+//Data EEPROM at EEADRH:EEADR.  EEDATA is valid on the instruction after RD.
+#define HAL_EEPROM_READ() EECON1bits.RD=1
+//Unlock sequence and start of the write, with interrupts off
+#define HAL_EEPROM_WRITE() do{ \
+    EECON2=0x55; \
+    EECON2=0xAA; \
+    EECON1bits.WR=1; \
+}while(0)
+//SLEEP() until the write is done, EEIE must be on to end it
+#define HAL_EEPROM_WAIT() while(EECON1bits.WR){ SLEEP(); }
+
+#endif
+
+#endif	/* INC_HAL_H */
@@ -0,0 +1,161 @@
+/**
+ * journal.c
+ * Wear levelled tip and message counts in the data EEPROM, see journal.h
+ */
+
+#include <xc.h>
+#include "journal.h"
+#include "eedata.h"
+#include "CRC16.h"
+
+#define HEADER_LAP0 0xA4 //Header of a record written on an even pass round the ring
+#define HEADER_LAP1 0xA5 //and on an odd pass.  Erased cells (0xFF) count as lap 1
+
+static uint8_t nextSlot = 0; //Where the next record goes
+static uint8_t nextLap = 0;
+static uint8_t format = 1; //No valid record, clear the headers before the first write
+static uint32_t savedTips = 0; //What the newest record holds
+static uint32_t savedMessages = 0;
+static uint8_t wakes = 0; //Watchdog wakes since the newest record
+
+static uint8_t lap(uint8_t);
+static uint8_t readRecord(uint8_t, uint32_t*, uint32_t*);
+
+/**
+ * Which pass round the ring wrote a slot, from its header alone.
+ */
+static uint8_t lap(uint8_t slot){
+    return EEDataRead((uint16_t)slot * JOURNAL_RECORD) != HEADER_LAP0;
+}
+
+/**
+ * Reads a record and checks its CRC16.
+ * @return 1 if the record is whole
+ */
+static uint8_t readRecord(uint8_t slot, uint32_t* tips, uint32_t* messages){
+    uint8_t record[JOURNAL_RECORD];
+    uint16_t address = (uint16_t)slot * JOURNAL_RECORD;
+    for(uint8_t i=0;i<JOURNAL_RECORD;i++){
+        record[i] = EEDataRead(address + i);
+    }
+    if(record[0] != HEADER_LAP0 && record[0] != HEADER_LAP1){
+        return 0;
+    }
+    unsigned short int calcCRC = CRC16(record, JOURNAL_RECORD-2);
+    if(record[9] != (calcCRC & 0xFF) || record[10] != (calcCRC >> 8)){
+        return 0;
+    }
+    *tips = (uint32_t)record[1]<<24 | (uint32_t)record[2]<<16 | (uint32_t)record[3]<<8 | record[4];
+    *messages = (uint32_t)record[5]<<24 | (uint32_t)record[6]<<16 | (uint32_t)record[7]<<8 | record[8];
+    return 1;
+}
+
+/**
+ * Finds the newest record after a reset.  The slots before it have the lap
+ * of slot 0 and the ones after it the other lap, so a binary search finds
+ * it in at most 7 header reads and 2 record reads.  If it was cut short
+ * the one before it is used and the next checkpoint writes over it.
+ * @param tips  Set to the saved tip count
+ * @param messages  Set past any message count that can have been sent since
+ * @return 1 if the counts were recovered, 0 for a blank EEPROM
+ */
+uint8_t journalRecover(uint32_t* tips, uint32_t* messages){
+    uint8_t firstLap = lap(0);
+    uint8_t low = 1;
+    uint8_t high = JOURNAL_SLOTS;
+    while(low < high){ //First slot from the previous lap, JOURNAL_SLOTS if none
+        uint8_t middle = (low + high) / 2;
+        if(lap(middle) == firstLap){
+            low = middle + 1;
+        }
+        else{
+            high = middle;
+        }
+    }
+    uint8_t newest = low - 1;
+    nextSlot = low;
+    nextLap = firstLap;
+    if(nextSlot == JOURNAL_SLOTS){
+        nextSlot = 0;
+        nextLap = !firstLap;
+    }
+    format = 0;
+    if(!readRecord(newest, &savedTips, &savedMessages)){
+        nextSlot = newest; //Finish the write the power failure stopped
+        nextLap = firstLap;
+        if(!readRecord(newest ? newest - 1 : JOURNAL_SLOTS - 1, &savedTips, &savedMessages)){
+            nextSlot = 0;
+            nextLap = 0;
+            format = 1;
+            savedTips = 0;
+            savedMessages = 0;
+            wakes = 0;
+            return 0;
+        }
+    }
+    *tips = savedTips;
+    *messages = savedMessages + JOURNAL_MESSAGE_GAP;
+    wakes = JOURNAL_WAKES; //Save the new message count at the first checkpoint
+    return 1;
+}
+
+void journalWake(){
+    if(wakes < 255){
+        wakes++;
+    }
+}
+
+/**
+ * Whether the counts should be saved now.
+ * @param tips  Tip count
+ * @param messages  Message count
+ * @return 1 after JOURNAL_TIPS tips, or JOURNAL_WAKES watchdog wakes with
+ * anything changed, since the last checkpoint
+ */
+uint8_t journalDue(uint32_t tips, uint32_t messages){
+    if(tips - savedTips >= JOURNAL_TIPS){
+        return 1;
+    }
+    return wakes >= JOURNAL_WAKES && (tips != savedTips || messages != savedMessages);
+}
+
+/**
+ * Saves the counts in the next slot.  Takes up to 45ms, so call it with the
+ * CPU idling on the slow clock (clockIdle()).  Tips are still counted if
+ * interrupts were on.
+ * @param tips  Tip count
+ * @param messages  Message count
+ */
+void journalCommit(uint32_t tips, uint32_t messages){
+    uint8_t record[JOURNAL_RECORD];
+    record[0] = nextLap ? HEADER_LAP1 : HEADER_LAP0;
+    record[1] = (uint8_t)((tips>>24)&0xFF); //MSB
+    record[2] = (uint8_t)((tips>>16)&0xFF);
+    record[3] = (uint8_t)((tips>>8)&0xFF);
+    record[4] = (uint8_t)(tips & 0xFF); //LSB
+    record[5] = (uint8_t)((messages>>24)&0xFF); //MSB
+    record[6] = (uint8_t)((messages>>16)&0xFF);
+    record[7] = (uint8_t)((messages>>8)&0xFF);
+    record[8] = (uint8_t)(messages & 0xFF); //LSB
+    unsigned short int calcCRC = CRC16(record, JOURNAL_RECORD-2);
+    record[9] = (calcCRC&0xFF); //LSB
+    record[10] = (calcCRC&0xFF00u)>>8u; //MSB
+
+    if(format){ //Leftovers could upset the search in journalRecover(), a blank EEPROM needs no writes
+        static const uint8_t erased = 0xFF;
+        for(uint8_t slot=0;slot<JOURNAL_SLOTS;slot++){
+            EEDataWrite((uint16_t)slot * JOURNAL_RECORD, &erased, 1);
+        }
+        format = 0;
+    }
+    EEDataWrite((uint16_t)nextSlot * JOURNAL_RECORD, record, JOURNAL_RECORD); //Header first
+
+    savedTips = tips;
+    savedMessages = messages;
+    wakes = 0;
+    nextSlot++;
+    if(nextSlot == JOURNAL_SLOTS){
+        nextSlot = 0;
+        nextLap = !nextLap;
+    }
+}
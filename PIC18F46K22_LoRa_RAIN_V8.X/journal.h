@@ -0,0 +1,43 @@
+/*
+ * File:   journal.h
+ * Author: Andy Page
+ * Comments: Keeps the tip and message counts in the 1KB data EEPROM so they
+ * survive a brown out or a battery change.
+ * The first JOURNAL_SIZE bytes of EEPROM are a ring of JOURNAL_SLOTS records, each written in turn, so
+ * every cell takes its share of the writes.  A record is a header, the two
+ * counts and a CRC16.  The header says which pass round the ring wrote it
+ * (the lap), so the newest record is the last one before the lap changes and
+ * a binary search finds it in a few reads however full the ring is.  A record
+ * cut short by a power failure fails its CRC and the one before it is used.
+ * Bytes that already hold the right value are not written again.
+ * journalDue() limits the writes: a checkpoint every JOURNAL_TIPS tips, or
+ * after JOURNAL_WAKES watchdog wakes if anything has changed.  Tips after
+ * the last checkpoint are lost with the power, and the message count is
+ * moved on past any that can have been sent since, so it never goes back.
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_JOURNAL_H
+#define	INC_JOURNAL_H
+
+#include <stdint.h>
+#include "backlog.h" //BACKLOG_DRAIN_PACKETS, backlog.h includes this for JOURNAL_SIZE
+
+#define JOURNAL_SIZE 768 //Bytes of EEPROM, the backlog has the rest
+#define JOURNAL_RECORD 11 //Header, tips, message count, CRC16
+#define JOURNAL_SLOTS (JOURNAL_SIZE / JOURNAL_RECORD)
+#define JOURNAL_TIPS 8 //Checkpoint after this many tips
+#define JOURNAL_WAKES 28 //Or after about an hour of watchdog wakes
+//Most messages that can go between checkpoints: a report per watchdog wake
+//and per tip window, which needs at least a tip, each followed by up to
+//BACKLOG_DRAIN_PACKETS more
+#define JOURNAL_MESSAGE_GAP ((1 + BACKLOG_DRAIN_PACKETS) * (JOURNAL_WAKES + JOURNAL_TIPS))
+
+uint8_t journalRecover(uint32_t*, uint32_t*); //Tips and message count, returns 0 if there is no record
+void journalWake(void); //Counts a watchdog wake for journalDue()
+uint8_t journalDue(uint32_t, uint32_t); //Tips and message count
+void journalCommit(uint32_t, uint32_t); //Tips and message count
+
+#endif	/* INC_JOURNAL_H */
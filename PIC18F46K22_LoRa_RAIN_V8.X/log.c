@@ -0,0 +1,48 @@
+/**
+ * log.c
+ * RAM ring buffer of events, see log.h
+ */
+
+#include <xc.h>
+#include "log.h"
+
+#if LOG_EVENTS > 0
+
+#if (LOG_EVENTS & (LOG_EVENTS - 1)) || LOG_EVENTS > 128
+#error "LOG_EVENTS must be a power of 2 up to 128 so logNext can wrap"
+#endif
+
+LogEvent logEvents[LOG_EVENTS];
+uint8_t logNext = 0;
+static uint8_t logFull = 0;
+
+/**
+ * Records an event, overwriting the oldest once the buffer is full.
+ * @param event  Event code (EV_...)
+ * @param value  Value to keep with it
+ */
+void logEvent(uint8_t event, uint16_t value){
+    LogEvent* entry = &logEvents[logNext % LOG_EVENTS];
+    entry->event = event;
+    entry->value = value;
+    logNext++;
+    if(logNext == LOG_EVENTS){
+        logFull = 1;
+    }
+}
+
+/**
+ * Prints the events still in the buffer, oldest first, one per line as
+ * sequence number, event code and value in hex.
+ */
+void logDump(){
+    uint8_t count = logFull ? LOG_EVENTS : logNext;
+    uint8_t sequence = logNext - count;
+    for(uint8_t i=0;i<count;i++){
+        const LogEvent* entry = &logEvents[sequence % LOG_EVENTS];
+        printf("%02X %02X %04X\r\n", sequence, entry->event, entry->value);
+        sequence++;
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * File:   log.h
+ * Author: Andy Page
+ * Comments: Compile time logging.
+ * LOG_ERROR(), LOG_INFO() and LOG_DEBUG() take printf arguments in an extra
+ * pair of brackets, e.g. LOG_INFO(("BATT %d\r\n", batt));  Anything above
+ * LOG_LEVEL compiles to nothing, arguments included, so the production build
+ * (LOG_LEVEL_NONE) never waits on the UART.
+ * LOG_EVENT() records an event code and a 16 bit value in a small RAM ring
+ * buffer instead, which costs a few instructions and no UART time.  It is
+ * kept through sleep and can be read with the debugger or sent out with
+ * logDump().  Set LOG_EVENTS to 0 to leave it out.
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_LOG_H
+#define	INC_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+
+#ifndef LOG_EVENTS
+#define LOG_EVENTS 16 //Entries in the event ring buffer (a power of 2 up to 128), 0 for none
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(args) printf args
+#else
+#define LOG_ERROR(args)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(args) printf args
+#else
+#define LOG_INFO(args)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(args) printf args
+#else
+#define LOG_DEBUG(args)
+#endif
+
+//Event codes for LOG_EVENT()
+#define EV_WAKE 0x01 //value is the low 16 bits of the tip count
+#define EV_UVLO 0x02 //value is the battery reading
+#define EV_SPURIOUS_WAKE 0x03 //Woken with nothing to do, value is RCON
+#define EV_RECOVERED 0x04 //Counts read back from EEPROM after a reset, value is the low 16 bits of the tip count
+#define EV_CHECKPOINT 0x05 //Counts saved to EEPROM, value is the low 16 bits of the tip count
+#define EV_QUEUED 0x06 //Reading added to the backlog, value is the message count
+#define EV_FORWARDED 0x07 //Backlog readings went in a packet, value is how many
+#define EV_AGED_OUT 0x08 //Backlog readings too old to send dropped, value is how many
+#define EV_LORA_COLD 0x10 //Radio configured from scratch
+#define EV_LORA_WARM 0x11 //Radio had kept its configuration
+#define EV_TX_START 0x12 //value is the packet length
+#define EV_TX_DONE 0x13 //value is the message count
+#define EV_TX_TIMEOUT 0x14 //value is the message count
+
+typedef struct {
+    uint8_t event;
+    uint16_t value;
+} LogEvent;
+
+#if LOG_EVENTS > 0
+extern LogEvent logEvents[LOG_EVENTS];
+extern uint8_t logNext; //Counts every event, logNext % LOG_EVENTS is the next entry
+void logEvent(uint8_t, uint16_t);
+void logDump(void); //Sends the event log out of USART2, oldest first
+#define LOG_EVENT(event, value) logEvent(event, value)
+#else
+#define LOG_EVENT(event, value)
+#endif
+
+#endif	/* INC_LOG_H */
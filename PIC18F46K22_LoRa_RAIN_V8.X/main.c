@@ -5,8 +5,16 @@
  * LoRa Rain Gauge
  * 
  * Transmits when a rain tip occurs or every 2 minutes if there is no rainfall.
+ * Tips are debounced and the ones that come within TIP_WINDOW_MS of the first
+ * go out together in one packet.
  * Keeps a count of the total tips which is transmitted (32 bit unsigned integer).
- * The counter is not reset unless the power is removed.
+ * The tip and message counts are saved in the data EEPROM (journal.c) and
+ * carry on from there after the power is removed.
+ * Readings whose packet did not get through are kept in the EEPROM too
+ * (backlog.c) and go out in the data area of later packets, and the rest of
+ * the data area repeats the last few readings in case a packet was missed.
+ * On a low battery the regular report is sent less often and at lower power,
+ * and below UVLO only a short low battery packet goes out now and then.
  * 
  * Sleep current consumption is 12A with standard PIC18F46K22.
  * Could reduce to 1A using PIC18LF46K22.
@@ -14,7 +22,10 @@
  * 
  * AN0 reads battery voltage through a resistor divider (30k/10k) with 1.024V internal reference
  * AN1 reads local temperature through 10k NTC and 10k resistor as a divider from 3.3V
- * RB2 (INT1) is rain tip input.
+ * RB1 (INT1) is rain tip input.
+ * RB2 is driven low.  With TX_DONE_INTERRUPT it is INT2, DIO0 from the LoRa
+ * module, which goes high at the end of a transmission; the board needs that
+ * link added, as the schematic leaves both unconnected.
  *
  * Created on 19 March 2021, 13:55
  * Version 2, 3rd April 2021, 20:44  Added internal temperature measurement and battery measurement.
@@ -23,6 +34,7 @@
  * Version 4, 11th June 2021, 20:40  Changed interrupt pin to RB1 (INT1)
  * Version 7, 8th Aug 2021, 15:26 Branch from correct working version 4 to add CRC16 to data stream.
  * Version 8, 18th Sept 2021, 12:04  Move to common 50 byte packet format
+ * Version 9, 15th October 2026  Tip histogram of the window in place of V1 and V2, readings in the data area
  */
 
 
@@ -36,85 +48,323 @@
 #include "usart2.h"
 #include "LoRa.h"
 #include "CRC16.h"
+#include "log.h"
+#include "clock.h"
+#include "journal.h"
+#include "backlog.h"
+#include "compact.h"
+#include "packet.h"
+#include "adc.h"
+#include "hal.h"
 
-#define DEBUG 0
-#define TX_FREQ 866.5
+#ifndef TX_DONE_INTERRUPT
+#define TX_DONE_INTERRUPT 0 //1 to sleep until DIO0 signals the end of transmission, needs DIO0 wired to RB2
+#endif
+#ifndef SENSOR_PIPELINE
+#define SENSOR_PIPELINE 1 //Bring the radio up while the dividers settle and the A to D converts, 0 for one after the other
+#endif
+#if ADC_POWER_UP_MS > LORA_COLD_START_MS
+#error "measure() relies on a cold start of the radio covering the divider settling time"
+#endif
+#define TX_FREQ 866500000UL //Hz
 #define SYNC_WORD 0x55
 #define BATT_UVLO 2000
 #define BATT_UVLO_ATOD BATT_UVLO/4
-#define DATA_PACKET_LENGTH 50
+#define BATT_LOW 2400 //mV
+#define BATT_LOW_ATOD (BATT_LOW/4)
+#ifndef PACKET_COMPACT
+#define PACKET_COMPACT 0 //1 for the compact format (compact.h), which the gateway must understand
+#endif
+#define PACKET_FULL 1 //transmitData() packet with every reading
+#define PACKET_LOW_BATTERY 0 //and without the temperature
+#if PACKET_COMPACT
+#define PACKET_MAX_LENGTH COMPACT_MAX_LENGTH
+#else
+#define PACKET_MAX_LENGTH DATA_PACKET_SENT
+#endif
 #define ID0 0x00
 #define ID1 0x01
-#define SOFTWARE_VERSION 0x08
+#define SOFTWARE_VERSION 0x09
+#define WDT_PERIOD_MS 131072UL //4ms * WDTPS 32768, see config.h
+
+//Time on air of the longest packet with the modem settings in LoRa.h
+//(97.536ms for the common format, 61.696ms compact)
+#define TX_AIRTIME_US LORA_TIME_ON_AIR_US(PACKET_MAX_LENGTH)
+#define TX_TIMEOUT_MS (TX_AIRTIME_US / 1000 + 2) //Airtime plus PA ramp up and crystal tolerance
+#define TX_POLL_MS 10
+#define DUTY_CYCLE_PERMILLE 10 //1% in the 865 to 868MHz sub-band (866.5MHz)
+#define TX_MIN_SPACING_MS LORA_MIN_SPACING_MS(TX_AIRTIME_US, DUTY_CYCLE_PERMILLE)
+#define TX_MAX_PER_HOUR LORA_PACKETS_PER_HOUR(TX_AIRTIME_US, DUTY_CYCLE_PERMILLE)
+#if TX_FREQ < 865000000UL || TX_FREQ > 868000000UL
+#error "TX_FREQ is outside the sub-band DUTY_CYCLE_PERMILLE is for"
+#endif
+#if TX_MIN_SPACING_MS > WDT_PERIOD_MS
+#error "One packet per watchdog period is over the duty cycle limit"
+#endif
+
+//The first tip after a packet opens a window, and the packet goes when it
+//closes with every tip counted in it.  The window starts after the previous
+//packet, so it is also the shortest time between packets.
+#define TIP_WINDOW_MS 30000UL
+#define TIP_DEBOUNCE_MS 200 //INT1 is ignored for this long after each tip
+#define TIP_WINDOW_TICKS (TIP_WINDOW_MS / TICK_MS)
+#define TIP_DEBOUNCE_TICKS (TIP_DEBOUNCE_MS / TICK_MS + 1) //The first tick comes early
+#if TIP_WINDOW_MS < TX_MIN_SPACING_MS
+#error "TIP_WINDOW_MS is shorter than the duty cycle allows between packets"
+#endif
+#if TIP_WINDOW_TICKS > 65535 || TIP_DEBOUNCE_TICKS > 255
+#error "TIP_WINDOW_MS or TIP_DEBOUNCE_MS is too long"
+#endif
+
+//Tips are also counted in TIP_BUCKETS slices of the window, sent as 2 bits
+//each (0 to 3, more show as 3) in the bytes the common format has for V1 and
+//V2, so the packet shows how hard it rained through the window.  Tips that
+//come while the window is not open count in the first bucket, as the first
+//tip opens it.
+#define TIP_BUCKETS 16
+#define TIP_BUCKET_TICKS ((TIP_WINDOW_TICKS + TIP_BUCKETS - 1) / TIP_BUCKETS)
+#define TIP_BUCKET_MAX 3
+#if TIP_BUCKET_TICKS > 255
+#error "TIP_BUCKET_TICKS is too long"
+#endif
+PACKET_ASSERT(TIP_HISTOGRAM_FITS, TIP_BUCKETS / 4 == DATA_PACKET_HISTOGRAM_SIZE);
+
+//Battery tiers.  Each one reports on every REPORT_EVERY_xxx watchdog wake
+//(or sooner for rain) at the given power, so a weak battery is asked for
+//fewer and smaller PA current pulses.  Tips are counted in every tier.
+#define REPORT_EVERY_NORMAL 1 //2 minutes
+#define REPORT_EVERY_LOW 4 //9 minutes, below BATT_LOW
+#define REPORT_EVERY_UVLO 16 //35 minutes, below BATT_UVLO
+#define PA_NORMAL LORA_PA_DEFAULT //17dBm, about 90mA
+#define PA_LOW LORA_PA_BOOST(10) //About 40mA
+#define PA_UVLO LORA_PA_BOOST(2) //About 25mA
+#define UVLO_LED_MS 20 //The LED only pulses below UVLO
+
+PACKET_ASSERT(BACKLOG_FITS, BACKLOG_PER_PACKET * BACKLOG_PACKED <= DATA_PACKET_CARRIED_SIZE);
+#if (1 + BACKLOG_DRAIN_PACKETS) * TX_MIN_SPACING_MS > TIP_WINDOW_MS
+#error "Backlog packets after a tip window would break the duty cycle"
+#endif
+
+typedef enum {
+    STATE_WINDOW, //Tip window open, counting tips on the slow clock
+    STATE_MEASURE, //Read the battery and temperature
+    STATE_TRANSMIT,
+    STATE_LOW_BATTERY,
+    STATE_SLEEP //Sleep until a tip or the watchdog
+} State;
 
 /**
  * Functions
  */
+State measure(void);
+void lowBattery(void);
+State sleepUntilWoken(void);
+void checkpoint(void);
 void configureIO(void);
 void disablePeripherals(void);
-void transmitData(void);
-uint16_t readBattery();
-uint16_t readTemperature();
-void setupAtoD();
+uint8_t transmitData(uint8_t, uint8_t);
+void coalesceTips(void);
+void debounceTip(void);
+void endDebounce(void);
 
 /**
  * Variables
  */
 volatile uint32_t tips=0;
+volatile uint8_t tipsUnsent=0; //Set by a tip, cleared once the count is in a packet
+volatile uint8_t debounceTicks=0; //Ticks left before INT1 is turned back on, 0 when it is on
+#if TX_DONE_INTERRUPT
+volatile uint8_t txDoneSeen=0; //DIO0 has signalled TxDone
+#endif
+volatile uint16_t windowTicks=0; //Ticks left in the coalescing window
+volatile uint8_t windowOpen=0; //windowTicks is non zero, can be read without turning interrupts off
+volatile uint8_t tipBuckets[TIP_BUCKETS]; //Tips in each slice of the window since the last packet
+volatile uint8_t tipBucket=0; //Slice of the window now
+volatile uint8_t bucketTicks=0; //Ticks left in it
 uint32_t messageCount=0; //Increments by 1 for each message transmitted.
-uint8_t txData[DATA_PACKET_LENGTH]; //Transmit buffer
 uint16_t batt=0; //Battery voltage A to D reading
 uint16_t temp=0; //Temperature A to D reading
+uint8_t reportEvery=REPORT_EVERY_NORMAL; //Watchdog wakes per report for the battery tier
+uint8_t watchdogWakes=0; //Since the last report
+uint8_t readingKept=0; //The battery and temperature reading has been sent in full or queued in the backlog
 uint8_t address[8] = {0xE6,0xBA,0x08,0xFB,0x3A,0x4F,0x5E,0xCE}; //This should be unique
 
 void main(void) {
+    State state = STATE_MEASURE; //Report straight away after power on
+    uint32_t savedTips;
+    uint32_t savedMessages;
+    if(journalRecover(&savedTips, &savedMessages)){
+        tips = savedTips;
+        messageCount = savedMessages;
+        LOG_EVENT(EV_RECOVERED, (uint16_t)tips);
+    }
+    backlogInit();
     INTCON2bits.INTEDG1=0; //Interrupt on falling edge
-    start:
-    configureIO();
-    setupAtoD(); //Setup to read AN0 (reads supply voltage [battery])
-    __delay_ms(5); //Wait for things to power up
-    if(DEBUG){
-        printf("LoRa Rain Gauge\r\n");
+    for(;;){
+        switch(state){
+            case STATE_WINDOW:
+                if(reportEvery == REPORT_EVERY_UVLO){
+                    //Rain does not bring the low battery packet forward, so
+                    //there is no window to pay for
+                    debounceTip();
+                    tipsUnsent=0;
+                    state = STATE_SLEEP;
+                    break;
+                }
+                coalesceTips();
+                state = STATE_MEASURE;
+                break;
+            case STATE_MEASURE:
+                state = measure();
+                break;
+            case STATE_TRANSMIT:
+                if(transmitData(PACKET_FULL, batt>BATT_LOW_ATOD ? PA_NORMAL : PA_LOW) && batt>BATT_LOW_ATOD){
+                    //The radio is getting through, so catch up on the backlog
+                    for(uint8_t i=0;i<BACKLOG_DRAIN_PACKETS && backlogCount();i++){
+                        if(!transmitData(PACKET_FULL, PA_NORMAL)){
+                            break;
+                        }
+                    }
+                }
+                state = STATE_SLEEP;
+                break;
+            case STATE_LOW_BATTERY:
+                lowBattery();
+                state = STATE_SLEEP;
+                break;
+            case STATE_SLEEP:
+            default:
+                state = sleepUntilWoken();
+                break;
+        }
     }
-    batt = readBattery();
-    temp = readTemperature();
-    if(DEBUG){
-        printf("BATT %d\r\n", batt);
-        printf("TEMP %d\r\n", temp);
+}
+
+/**
+ * Powers up the dividers, reads the battery and temperature and picks the
+ * battery tier.  With SENSOR_PIPELINE the radio is brought up at the same
+ * time, so transmitData() finds it ready: a cold start idles for longer
+ * than the dividers need to settle, so they settle during it, and on a warm
+ * start the conversions run on ADIF while its oscillator starts.  The radio
+ * is kept asleep while the dividers settle on a warm start, as standby for
+ * that long costs more than the oscillator wait it would hide.
+ * @return STATE_TRANSMIT, or STATE_LOW_BATTERY below the UVLO threshold
+ */
+State measure(){
+    configureIO();
+    adcSetup();
+#if SENSOR_PIPELINE
+    uint8_t radio = LoRaWake(LORA_FRF(TX_FREQ), SYNC_WORD);
+    if(radio != LORA_WAKE_COLD){
+        clockSleepMs(ADC_POWER_UP_MS); //Wait for things to power up
     }
-    if(batt>BATT_UVLO_ATOD){
-        transmitData();
+    adcStart();
+    if(radio == LORA_WAKE_ASLEEP){
+        LoRaOscillatorStart(); //While it converts
     }
-    else{
-        //Flash the red LED 3 times
-        RED_LED=1; //Red LED on
-        __delay_ms(300);
-        RED_LED=0;
-        __delay_ms(300);
-        RED_LED=1; //Red LED on
-        __delay_ms(300);
-        RED_LED=0;
-        __delay_ms(300);
-        RED_LED=1; //Red LED on
-        __delay_ms(300);
-        RED_LED=0;
-        __delay_ms(300);
+    LoRaClearIRQFlags(); //For transmitData()
+#else
+    clockSleepMs(ADC_POWER_UP_MS); //Wait for things to power up
+    adcStart();
+#endif
+    LOG_INFO(("LoRa Rain Gauge\r\n"));
+    LOG_EVENT(EV_WAKE, (uint16_t)tips);
+    adcWait();
+    batt = adcBattery();
+    temp = adcTemperature();
+    LOG_INFO(("BATT %d\r\n", batt));
+    LOG_INFO(("TEMP %d\r\n", temp));
+    watchdogWakes=0;
+    readingKept=0;
+    if(batt>BATT_LOW_ATOD){
+        reportEvery=REPORT_EVERY_NORMAL;
+        return STATE_TRANSMIT;
     }
-    if(DEBUG){
-        printf("Message count %lu\r\n", messageCount);
-        printf("Rain tips %lu\r\n", tips);
+    if(batt>BATT_UVLO_ATOD){
+        reportEvery=REPORT_EVERY_LOW;
+        return STATE_TRANSMIT;
     }
+    reportEvery=REPORT_EVERY_UVLO;
+    return STATE_LOW_BATTERY;
+}
+
+/**
+ * Sends the short low battery packet at the lowest power, so the battery
+ * is not pulled down to brown out under the full PA load, and pulses the
+ * LED briefly.  The full count of tips is in it, so none are lost, and the
+ * reading is queued in the backlog for its temperature.
+ */
+void lowBattery(){
+    LOG_EVENT(EV_UVLO, batt);
+    transmitData(PACKET_LOW_BATTERY, PA_UVLO);
+    RED_LED=1; //Red LED on
+    clockSleepMs(UVLO_LED_MS);
+    RED_LED=0;
+}
+
+/**
+ * Sleeps until there is something to do and works out what from the wake
+ * reason.  A tip (INT1) opens the tip window, and the watchdog (RCON TO
+ * clear) means it is time for the regular report once the battery tier's
+ * reportEvery wakes have gone by.  Anything else goes straight back to sleep
+ * without powering anything up.  Tips that came in after the last packet
+ * was made up open the window without sleeping.
+ * @return The state to run next
+ */
+State sleepUntilWoken(){
+    LOG_INFO(("Message count %lu\r\n", messageCount));
+    LOG_INFO(("Rain tips %lu\r\n", tips));
+    LOG_DEBUG(("Sleeping\r\n"));
     disablePeripherals();
-    if(DEBUG){
-        printf("Sleeping\r\n");
+    for(;;){
+        checkpoint();
+        //INT1 must be on, as nothing runs the debounce ticks in sleep
+        INTCONbits.GIE=0;
+        if(debounceTicks){
+            debounceTicks=0;
+            INTCON3bits.INT1IF=0;
+            INTCON3bits.INT1IE=1;
+        }
+        if(!tipsUnsent && !INTCON3bits.INT1IF){
+            SLEEP(); //Sets TO, a watchdog wake clears it
+        }
+        HAL_INTERRUPTS_ON(); //Isr() counts the tip that woke us
+        if(tipsUnsent){
+            return STATE_WINDOW;
+        }
+        if(!RCONbits.NOT_TO){
+            journalWake();
+            if(++watchdogWakes >= reportEvery){
+                return STATE_MEASURE;
+            }
+        }
+        else{
+            LOG_EVENT(EV_SPURIOUS_WAKE, RCON);
+        }
     }
-    SLEEP();
+}
 
-    goto start;
+/**
+ * Saves the tip and message counts in the EEPROM journal when journalDue()
+ * says it is time, with the CPU idling on the slow clock through the writes.
+ */
+void checkpoint(){
+    INTCONbits.GIE=0; //Isr() cannot change it between the bytes
+    uint32_t tipCount = tips;
+    HAL_INTERRUPTS_ON();
+    if(!journalDue(tipCount, messageCount)){
+        return;
+    }
+    LOG_EVENT(EV_CHECKPOINT, (uint16_t)tipCount);
+    clockIdle();
+    journalCommit(tipCount, messageCount);
+    clockRun();
 }
 
 void configureIO(){
-    PMD0bits.UART2MD=0; //Turn on UART2
+#if LOG_LEVEL > LOG_LEVEL_NONE
+    PMD0bits.UART2MD=0; //Turn on UART2, only needed for the log
+#endif
     PMD0bits.SPI2MD=0; //Turn on SPI2
     PMD2bits.ADCMD=0; //Turn on ADC
     ANSELAbits.ANSA2=0; //Analogue off
@@ -127,7 +377,14 @@ void configureIO(){
     TRISEbits.RE2=0; //Red LED for status
     ANSELBbits.ANSB1=0; //Turn off analogue on RB1
     TRISBbits.RB1=1; //RB1 is input (INT1)
+#if TX_DONE_INTERRUPT
+    ANSELBbits.ANSB2=0; //Turn off analogue on RB2
+    TRISBbits.RB2=1; //RB2 is input (INT2, LoRa DIO0)
+    INTCON2bits.INTEDG2=1; //DIO0 interrupt on rising edge
+#endif
+#if LOG_LEVEL > LOG_LEVEL_NONE
     USART2_Start(BAUD_57600); //Start USART2
+#endif
     //INTCONbits.INT0IE=1; //Enable interrupt on INT0 pin
     
     //INTCONbits.INT0IF=0; //Clear INT0 flag
@@ -137,10 +394,15 @@ void configureIO(){
 }
 
 void disablePeripherals(){
+    USART2_Flush(); //Let the log output finish before UART2 and its pins are turned off
     ADCON0bits.ADON=0; //Turn off A to D module
     //Set all pins as outputs
     TRISA=0;
-    TRISB=0x02; //Set all outputs except RB1
+#if TX_DONE_INTERRUPT
+    TRISB=0x06; //Set all outputs except RB1 and RB2 (driven by LoRa DIO0)
+#else
+    TRISB=0x02; //Set all outputs except RB1, RB2 is not connected
+#endif
     TRISC=0;
     TRISD=0;
     TRISE=0;
@@ -168,157 +430,249 @@ void disablePeripherals(){
     PMD2=0xFF; //Turn off all peripherals in PMD2 (ADC, comparators, CTMU)
 }
 
-void transmitData(){
-    if(DEBUG){
-        printf("Transmitting...\r\n");
-    }
+/**
+ * Makes up a packet and sends it.  The full packet has the temperature, the
+ * tip histogram of the window and the rest of the common 50 byte format, the
+ * low battery packet stops after the battery reading and the tip count.  Both
+ * end in the CRC16.  With PACKET_COMPACT they are in the compact format
+ * (compact.h) instead, with one reading carried.
+ * The full packet carries the oldest readings from the backlog, which are
+ * dropped from it once the packet has gone, and the last few that were sent.
+ * The reading is queued if it did not go out in full, unless an earlier
+ * packet already took care of it.
+ * @param full  PACKET_FULL, or PACKET_LOW_BATTERY for the short packet without temperature
+ * @param paConfig  Transmit power, RegPaConfig value
+ * @return 1 if TxDone came
+ */
+uint8_t transmitData(uint8_t full, uint8_t paConfig){
+    LOG_DEBUG(("Transmitting...\r\n"));
     
-    txData[0] = DATA_PACKET_LENGTH;
-    txData[1] = ID0; //Copy in the ID
-    txData[2] = ID1; //Copy in the ID
-    for(uint8_t i=0;i<8;i++){
-        txData[i+3] = address[i]; //Copy in the address
+    //Rain tip count and histogram
+    uint8_t histogram[TIP_BUCKETS];
+    INTCONbits.GIE=0; //Isr() cannot change them between the bytes
+    uint32_t tipCount = tips;
+    tipsUnsent=0; //Tips from here on go in the next packet
+    for(uint8_t i=0;i<TIP_BUCKETS;i++){
+        histogram[i] = tipBuckets[i];
+        tipBuckets[i] = 0;
     }
-    txData[11] = SOFTWARE_VERSION;
-    
-    //Message count
-    txData[12]=(uint8_t)((messageCount>>24)&0xFF); //MSB
-    txData[13]=(uint8_t)((messageCount>>16)&0xFF); //Upper middle
-    txData[14]=(uint8_t)((messageCount>>8)&0xFF); //Lower middle
-    txData[15]=(uint8_t)((messageCount & 0xFF)); //LSB
-    
-    //Supply voltage value (10-bit in 2 bytes)
-    txData[16]=(uint8_t)((batt>>8)&0xFF); //MSB
-    txData[17]=(uint8_t)(batt & 0xFF); //LSB
-    
-    //Sensor local temperature value (16-bit)
-    txData[18]=(uint8_t)((temp>>8)&0xFF); //MSB
-    txData[19]=(uint8_t)(temp & 0xFF); //LSB
-    
-    //V1 Voltage (0)
-    txData[20] = 0;
-    txData[21] = 0;
-    
-    //V2 Voltage (0)
-    txData[22] = 0;
-    txData[23] = 0;
-    
-    
-    //Rain tip count
-    txData[24]=(uint8_t)((tips>>24)&0xFF); //MSB
-    txData[25]=(uint8_t)((tips>>16)&0xFF); //Upper middle
-    txData[26]=(uint8_t)((tips>>8)&0xFF); //Lower middle
-    txData[27]=(uint8_t)((tips & 0xFF)); //LSB
-    
-    //Fill the rest of the data area with 0
-    for(uint8_t i=28;i<48;i++){
-        txData[i] = 0;
+    tipBucket=0;
+    HAL_INTERRUPTS_ON();
+    uint8_t packedHistogram[TIP_BUCKETS/4];
+    uint8_t rained = 0;
+    for(uint8_t i=0;i<TIP_BUCKETS;i++){
+        uint8_t count = histogram[i] > TIP_BUCKET_MAX ? TIP_BUCKET_MAX : histogram[i];
+        if((i & 3) == 0){
+            packedHistogram[i/4] = 0;
+        }
+        packedHistogram[i/4] |= (uint8_t)(count << (6 - 2 * (i & 3)));
+        rained |= count;
     }
     
-    //Calculate CRC16 and add to end of message
-    unsigned short int calcCRC = CRC16(txData, DATA_PACKET_LENGTH-2);
-    txData[49] = (calcCRC&0xFF00u)>>8u; //MSB
-    txData[48] = (calcCRC&0xFF); //LSB
-
+    //Set the transmitter up and fill its FIFO
+    LoRaStart(LORA_FRF(TX_FREQ), SYNC_WORD); //Configure module
+    LoRaSetPower(paConfig);
+    LOG_DEBUG(("TXF: %lu\r\n", LoRaGetFrequency()));
+#if !SENSOR_PIPELINE
+    LoRaClearIRQFlags(); //measure() did, and every packet after clears them once it has gone
+#endif
     
-    //Set the transmitter up and send the data
-    LoRaStart(TX_FREQ, SYNC_WORD); //Configure module
-    if(DEBUG){
-        printf("TXF: %f\r\n", LoRaGetFrequency());
+    uint8_t carried = 0;
+#if PACKET_COMPACT
+    uint8_t readings[COMPACT_CARRIED * BACKLOG_PACKED];
+    readings[0] = 0;
+    if(full){
+        //Readings that did not get through before, or the last one that did
+        carried = backlogFill(readings, COMPACT_CARRIED, messageCount, tipCount);
     }
-    LoRaClearIRQFlags();
-    RED_LED=1; //Red LED on
-    LoRaTXData(txData, DATA_PACKET_LENGTH); //Send data
-    if(DEBUG){
-        printf("Wait for end of transmission...\r\n");
+    uint8_t packet[COMPACT_MAX_LENGTH];
+    uint8_t length = compactPacket(packet, compactAddressHash(ID0, ID1, address), messageCount, tipCount,
+                                   batt, full ? temp : COMPACT_NO_TEMPERATURE,
+                                   full && rained ? packedHistogram : 0, readings, COMPACT_CARRIED);
+    LoRaFIFOBegin();
+    for(uint8_t i=0;i<length;i++){
+        LoRaFIFOWrite(packet[i]);
+    }
+    LoRaFIFOEnd();
+#else
+    //Each field goes straight into the FIFO, placed by packet.h, and the
+    //CRC16 is worked out on the way.  The header is the same in both formats.
+    static const uint8_t id[] = {ID0, ID1};
+    uint8_t readings[BACKLOG_PER_PACKET * BACKLOG_PACKED];
+    if(full){
+        //Readings that did not get through before, then the last few that did
+        carried = backlogFill(readings, BACKLOG_PER_PACKET, messageCount, tipCount);
     }
-    uint8_t j=0;
-    for(j=0;j<50;j++){
-        uint8_t flags = LoRaGetIRQFlags();
-        //printf("IRQ %d %d \r\n",j, flags);
-        if(flags>0){
+    packetBegin();
+    PACKET_SEND(DATA_PACKET, LENGTH, full ? DATA_PACKET_SENT : LOW_BATTERY_PACKET_SENT);
+    PACKET_SEND_BYTES(DATA_PACKET, ID, id);
+    PACKET_SEND_BYTES(DATA_PACKET, ADDRESS, address);
+    PACKET_SEND(DATA_PACKET, VERSION, SOFTWARE_VERSION);
+    PACKET_SEND(DATA_PACKET, MESSAGE, messageCount);
+    PACKET_SEND(DATA_PACKET, BATTERY, batt); //10-bit supply voltage
+    uint8_t length;
+    if(full){
+        PACKET_SEND(DATA_PACKET, TEMPERATURE, temp);
+        PACKET_SEND_BYTES(DATA_PACKET, HISTOGRAM, packedHistogram); //V1 and V2 are not used
+        PACKET_SEND(DATA_PACKET, TIPS, tipCount);
+        packetBytes(DATA_PACKET_CARRIED_AT, readings, sizeof(readings)); //Zeros after them
+        length = PACKET_END(DATA_PACKET);
+    }
+    else{
+        PACKET_SEND(LOW_BATTERY_PACKET, TIPS, tipCount);
+        length = PACKET_END(LOW_BATTERY_PACKET);
+    }
+#endif
+    
+    RED_LED=1; //Red LED on
+#if TX_DONE_INTERRUPT
+    //Idle through the transmission on the slow clock.  DIO0 is mapped to
+    //TxDone and its INT2 edge has Isr() set txDoneSeen, which ends the wait.
+    //If DIO0 never comes Timer3 ends it after TX_TIMEOUT_MS, like the polling.
+    //Tips are counted as usual.
+    INTCONbits.GIE=0;
+    txDoneSeen=0;
+    INTCON3bits.INT2IF=0;
+    INTCON3bits.INT2IE=1;
+    HAL_INTERRUPTS_ON();
+    LoRaTXStart(length); //Send data
+    uint8_t txDone = clockSleepUntil(TX_TIMEOUT_MS, &txDoneSeen);
+    INTCON3bits.INT2IE=0;
+#else
+    LoRaTXStart(length); //Send data
+    LOG_DEBUG(("Wait for end of transmission...\r\n"));
+    uint8_t txDone=0;
+    for(uint8_t j=0;j<=(TX_TIMEOUT_MS+TX_POLL_MS-1)/TX_POLL_MS;j++){
+        if(LoRaGetIRQFlags()>0){
+            txDone=1;
             break;
         }
-        __delay_ms(10); //We are done with transmission
+        clockSleepMs(TX_POLL_MS); //We are done with transmission
+    }
+#endif
+    if(!txDone){
+        LOG_ERROR(("TX Fail\r\n"));
+        LOG_EVENT(EV_TX_TIMEOUT, (uint16_t)messageCount);
     }
-    if(DEBUG){
-        if(j>48){
-            printf("TX Fail\r\n");
+    else{
+        LOG_DEBUG(("Done.\r\n"));
+        LOG_EVENT(EV_TX_DONE, (uint16_t)messageCount);
+    }
+    LoRaClearIRQFlags(); //Take DIO0 low again
+    LoRaSleepMode(); //Put module to sleep
+    clockSleepMs(10);
+    uint8_t queue = !readingKept && !(txDone && full);
+    if(!readingKept && !queue){
+        backlogRemember(messageCount, tipCount, batt, temp); //Goes again in the next few packets
+    }
+    if(queue || (txDone && carried)){
+        clockIdle(); //Through the EEPROM writes
+        if(queue){
+            LOG_EVENT(EV_QUEUED, (uint16_t)messageCount);
+            backlogAdd(messageCount, tipCount, batt, temp);
         }
         else{
-            printf("Done.\r\n");
+            LOG_EVENT(EV_FORWARDED, carried);
+            backlogSent();
         }
+        clockRun();
     }
-    LoRaSleepMode(); //Put module to sleep
-    __delay_ms(10);
+    readingKept=1;
     messageCount++;
     RED_LED=0; //Red LED off
+    return txDone;
 }
 
 /**
- * Reads the supply voltage A to D
+ * Waits out the window opened by the first tip after a packet, counting any
+ * more tips that come in it, so a burst of tips costs one packet.  The CPU
+ * idles on the slow clock while Timer1 times the window and the debounce.
+ * Runs before configureIO() so the external circuitry stays off.
  */
-uint16_t readBattery(){
-    ADCON1bits.PVCFG=0b10; //A/D Vref+ connected to internal reference FVR BUF2
-    ADCON0bits.GO_NOT_DONE=1; //Start the A to D process
-    while(ADCON0bits.GO_NOT_DONE){
-        //Wait for conversion to complete (about 15s)
+void coalesceTips(){
+    INTCONbits.GIE=0;
+    tipBucket=0; //The tip that opened it is in bucket 0
+    bucketTicks=TIP_BUCKET_TICKS;
+    windowTicks=TIP_WINDOW_TICKS;
+    windowOpen=1;
+    HAL_INTERRUPTS_ON();
+    clockSlow();
+    while(windowOpen || debounceTicks){
+        SLEEP(); //Idle until the next tick or tip
     }
-    uint16_t result = ADRESH * 256 + ADRESL; //Read A to D result
-    return result;
+    clockFast();
 }
 
-uint16_t readTemperature(){
-    ADCON1bits.PVCFG=0; //A/D Vref+ connected to Vdd
-    //Select channel 1 for A to D
-    ADCON0bits.CHS=1;
-    ADCON0bits.GO_NOT_DONE=1; //Start the A to D process
-    while(ADCON0bits.GO_NOT_DONE){
-        //Wait for conversion to complete (about 15s)
+/**
+ * Idles on the slow clock until the tip that woke us has stopped bouncing,
+ * without opening a window, for the UVLO tier.
+ */
+void debounceTip(){
+    clockSlow();
+    while(debounceTicks){
+        SLEEP(); //Idle until the next tick
     }
-    uint16_t result = ADRESH * 256 + ADRESL; //Read A to D result
-    return result;
+    clockFast();
 }
 
-void setupAtoD(){
-    //Setup AN0 for a to d converter (RA0)
-    
-    //Set ANSELbit to disable digital input buffer
-    ANSELAbits.ANSA0=1;
-    ANSELAbits.ANSA1=1;
-    
-    //Set TRISXbit to disable digital output driver
-    TRISAbits.RA0=1;
-    TRISAbits.RA1=1;
-    
-    //Set voltage references
-    ADCON1bits.PVCFG=0; //A/D Vref+ connected to Vdd
-    ADCON1bits.NVCFG=0; //A/D Vref- connected to internal signal AVss
-    VREFCON0bits.FVRS=0b01; //Fixed voltage reference is 1.024V
-    VREFCON0bits.FVREN=1; //Enable internal reference
-    
-    //Select channel 0 for A to D
-    ADCON0bits.CHS=0;
-    
-    //Set A to D acquisition time
-    ADCON2bits.ACQT=0b010; //Tacq = 4 Tad (4s)
-    
-    //Set A to D clock period
-    ADCON2bits.ADCS=0b110; //Clock period set to Fosc/64 = 1s (64MHz clock)
-    
-    //Set result format
-    ADCON2bits.ADFM = 1; //Data is mostly in the ADRESL register with 2 bits in the ADRESH register
-    
-    //Turn on the A to D module
-    ADCON0bits.ADON=1;
+/**
+ * Turns INT1 back on at the end of a tip's debounce time, called from Isr().
+ * Edges seen while it was off are switch bounce, so their flag is thrown away.
+ */
+void endDebounce(){
+    INTCON3bits.INT1IF=0;
+    INTCON3bits.INT1IE=1;
 }
 
 void __interrupt() Isr(void){
-    if(INTCON3bits.INT1F==1){
+    if(INTCON3bits.INT1E && INTCON3bits.INT1F){
         tips++; //Increase rain tip count
         INTCON3bits.INT1F=0; //Clear INT1 flag
-        RED_LED=1;
+        INTCON3bits.INT1E=0; //Ignore the reed switch until it has stopped bouncing
+        debounceTicks=TIP_DEBOUNCE_TICKS;
+        tipsUnsent=1;
+        if(tipBuckets[tipBucket] < 255){
+            tipBuckets[tipBucket]++;
+        }
+        RED_LED=1; //Flash until the next tick
+    }
+    if(PIE1bits.TMR1IE && PIR1bits.TMR1IF){
+        clockTick();
+        RED_LED=0;
+        if(debounceTicks){
+            debounceTicks--;
+            if(!debounceTicks){
+                endDebounce();
+            }
+        }
+        if(windowTicks){
+            windowTicks--;
+            if(!windowTicks){
+                windowOpen=0;
+                tipBucket=0; //Tips until the next window opens
+            }
+            else if(!--bucketTicks){
+                bucketTicks=TIP_BUCKET_TICKS;
+                tipBucket++;
+            }
+        }
+    }
+    if(PIE2bits.TMR3IE && PIR2bits.TMR3IF){
+        PIE2bits.TMR3IE=0; //End of clockSleepMs(), which clears the flag
+    }
+    if(PIE3bits.TX2IE && PIR3bits.TX2IF){
+        USART2_TXInterrupt(); //Next byte of log output
+    }
+    if(PIE1bits.ADIE && PIR1bits.ADIF){
+        adcInterrupt(); //Next reading
+    }
+#if TX_DONE_INTERRUPT
+    if(INTCON3bits.INT2IE && INTCON3bits.INT2IF){
+        INTCON3bits.INT2IF=0;
+        INTCON3bits.INT2IE=0; //Once per packet
+        txDoneSeen=1; //End of the wait in transmitData()
     }
+#endif
 }
 
 
@@ -0,0 +1,97 @@
+/**
+ * packet.c
+ * Sends the common packet format into the radio's FIFO a field at a time,
+ * see packet.h
+ */
+
+#include <stdint.h>
+#include "packet.h"
+#include "LoRa.h"
+#include "CRC16.h"
+
+static uint8_t sent = 0; //Bytes in the FIFO so far
+static unsigned short int crc = CRC16_INIT; //Of those bytes
+
+static void send(uint8_t);
+static void skipTo(uint8_t);
+
+static void send(uint8_t data){
+    LoRaFIFOWrite(data);
+#if PACKET_CRC & PACKET_CRC_SOFTWARE
+    crc = CRC16Update(crc, data);
+#endif
+    sent++;
+}
+
+/**
+ * Zeros up to the start of the next field, for any left out.
+ */
+static void skipTo(uint8_t at){
+    while(sent < at){
+        send(0);
+    }
+}
+
+/**
+ * Opens the FIFO for a packet.  Nothing else may use SPI2 until packetEnd().
+ */
+void packetBegin(){
+    LoRaFIFOBegin();
+    sent = 0;
+    crc = CRC16_INIT;
+}
+
+/**
+ * Sends a number field.  Use PACKET_SEND(), which looks up the field's place,
+ * size and byte order.
+ * @param at  Offset of the field, fields must come in order
+ * @param size  Bytes in the field, up to 4
+ * @param order  PACKET_MSB_FIRST or PACKET_LSB_FIRST
+ * @param value  Any bits that do not fit are dropped
+ */
+void packetNumber(uint8_t at, uint8_t size, uint8_t order, uint32_t value){
+    skipTo(at);
+    if(order == PACKET_MSB_FIRST){
+        value <<= 8 * (4 - size); //MSB of the field to the top
+        for(uint8_t i=0;i<size;i++){
+            send((uint8_t)(value >> 24));
+            value <<= 8;
+        }
+    }
+    else{
+        for(uint8_t i=0;i<size;i++){
+            send((uint8_t)(value & 0xFF));
+            value >>= 8;
+        }
+    }
+}
+
+/**
+ * Sends bytes as they are.  Use PACKET_SEND_BYTES() for a whole field.
+ * @param at  Offset of the field, fields must come in order
+ * @param data
+ * @param length  Up to the size of the field, the rest is sent as zeros
+ */
+void packetBytes(uint8_t at, const uint8_t* data, uint8_t length){
+    skipTo(at);
+    while(length--){
+        send(*data++);
+    }
+}
+
+/**
+ * Sends the CRC16 of everything before it, unless PACKET_CRC leaves the
+ * check to the radio, and closes the FIFO.  Use PACKET_END().
+ * @param at  Offset of the CRC16
+ * @return The packet length, for LoRaTXStart()
+ */
+uint8_t packetEnd(uint8_t at){
+    skipTo(at);
+#if PACKET_CRC & PACKET_CRC_SOFTWARE
+    unsigned short int calcCRC = crc;
+    send((uint8_t)(calcCRC & 0xFF)); //LSB
+    send((uint8_t)(calcCRC >> 8)); //MSB
+#endif
+    LoRaFIFOEnd();
+    return sent;
+}
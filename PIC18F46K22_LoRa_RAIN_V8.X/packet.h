@@ -0,0 +1,125 @@
+/*
+ * File:   packet.h
+ * Author: Andy Page
+ * Comments: The common packet format, written down once.  Each format is a
+ * list of fields (an X-macro): FIELD(format, name, offset, size, order) for
+ * every field in turn, which the generator macros below turn into the
+ * <format>_<name>_AT, _SIZE and _ORDER constants transmitData() sends with,
+ * a layout struct, and checks that fail to compile if a field overlaps the
+ * one before it, leaves a gap, or does not fit.  The host decoder
+ * (host/packet.hpp) builds its field accessors from the same lists, so a
+ * change here moves the encoder and the decoder together.
+ * Numbers are sent MSB first, except the CRC16 which is LSB first.  The
+ * CRC16 field is left off the end when PACKET_CRC (defines.h) leaves the
+ * check to the radio, so the packets are 48 and 22 bytes and the length
+ * byte says so.
+ * Revision history: 1, 15th October 2026
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef INC_PACKET_H
+#define	INC_PACKET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "defines.h"
+
+#define PACKET_BYTES 0 //Copied in as they are
+#define PACKET_MSB_FIRST 1
+#define PACKET_LSB_FIRST 2
+
+//Literals, as the packet lengths are needed in #if; the layout checks hold
+//them to the field lists
+#define DATA_PACKET_LENGTH 50
+#define LOW_BATTERY_PACKET_LENGTH 24
+#if PACKET_CRC & PACKET_CRC_SOFTWARE
+#define PACKET_CRC16_BYTES 2
+#else
+#define PACKET_CRC16_BYTES 0 //The radio's payload CRC does the job
+#endif
+//What goes on air, the length byte
+#define DATA_PACKET_SENT (DATA_PACKET_LENGTH - 2 + PACKET_CRC16_BYTES)
+#define LOW_BATTERY_PACKET_SENT (LOW_BATTERY_PACKET_LENGTH - 2 + PACKET_CRC16_BYTES)
+#if !(PACKET_CRC & PACKET_CRC_BOTH)
+#error "PACKET_CRC must have PACKET_CRC_SOFTWARE, PACKET_CRC_RADIO or both"
+#endif
+
+//Both formats start with the same header
+#define PACKET_HEADER_FIELDS(FIELD, format) \
+    FIELD(format, LENGTH, 0, 1, PACKET_MSB_FIRST) /* Of the whole packet */ \
+    FIELD(format, ID, 1, 2, PACKET_BYTES) /* ID0, ID1 */ \
+    FIELD(format, ADDRESS, 3, 8, PACKET_BYTES) /* Unique to each gauge */ \
+    FIELD(format, VERSION, 11, 1, PACKET_MSB_FIRST) /* SOFTWARE_VERSION */ \
+    FIELD(format, MESSAGE, 12, 4, PACKET_MSB_FIRST) \
+    FIELD(format, BATTERY, 16, 2, PACKET_MSB_FIRST) /* 10 bit A to D */
+
+//The full packet, with every reading
+#define DATA_PACKET_FIELDS(FIELD, format) \
+    PACKET_HEADER_FIELDS(FIELD, format) \
+    FIELD(format, TEMPERATURE, 18, 2, PACKET_MSB_FIRST) \
+    FIELD(format, HISTOGRAM, 20, 4, PACKET_MSB_FIRST) /* 2 bits a bucket, bucket 0 in the top bits */ \
+    FIELD(format, TIPS, 24, 4, PACKET_MSB_FIRST) \
+    FIELD(format, CARRIED, 28, 20, PACKET_BYTES) /* Earlier readings, see backlog.h */ \
+    FIELD(format, CRC, 48, 2, PACKET_LSB_FIRST)
+
+//Sent below BATT_UVLO, without the temperature
+#define LOW_BATTERY_PACKET_FIELDS(FIELD, format) \
+    PACKET_HEADER_FIELDS(FIELD, format) \
+    FIELD(format, TIPS, 18, 4, PACKET_MSB_FIRST) \
+    FIELD(format, CRC, 22, 2, PACKET_LSB_FIRST)
+
+//Fails to compile, with a negative array size, unless condition holds
+#define PACKET_ASSERT(name, condition) typedef char name[(condition) ? 1 : -1]
+
+//Generators, each given one field
+#define PACKET_CONSTANTS(format, name, at, size, order) \
+    format##_##name##_AT = (at), format##_##name##_SIZE = (size), format##_##name##_ORDER = (order),
+#define PACKET_MEMBER(format, name, at, size, order) uint8_t name[size];
+#define PACKET_CHECK(format, name, at, size, order) \
+    PACKET_ASSERT(format##_##name##_CHECK, offsetof(format##_LAYOUT, name) == (at) \
+                  && ((order) == PACKET_BYTES || (size) <= 4));
+
+enum {
+    DATA_PACKET_FIELDS(PACKET_CONSTANTS, DATA_PACKET)
+    LOW_BATTERY_PACKET_FIELDS(PACKET_CONSTANTS, LOW_BATTERY_PACKET)
+    PACKET_CONSTANTS_END //C90 has no comma after the last one
+};
+
+//Byte arrays have no padding, so each member's offset is the sum of the
+//sizes before it
+typedef struct {
+    DATA_PACKET_FIELDS(PACKET_MEMBER, DATA_PACKET)
+} DATA_PACKET_LAYOUT;
+
+typedef struct {
+    LOW_BATTERY_PACKET_FIELDS(PACKET_MEMBER, LOW_BATTERY_PACKET)
+} LOW_BATTERY_PACKET_LAYOUT;
+
+DATA_PACKET_FIELDS(PACKET_CHECK, DATA_PACKET)
+LOW_BATTERY_PACKET_FIELDS(PACKET_CHECK, LOW_BATTERY_PACKET)
+PACKET_ASSERT(DATA_PACKET_FITS, sizeof(DATA_PACKET_LAYOUT) == DATA_PACKET_LENGTH);
+PACKET_ASSERT(LOW_BATTERY_PACKET_FITS, sizeof(LOW_BATTERY_PACKET_LAYOUT) == LOW_BATTERY_PACKET_LENGTH);
+//packetEnd() sends the CRC16 LSB first as the last 2 bytes, or stops there
+PACKET_ASSERT(DATA_PACKET_CRC_LAST, DATA_PACKET_CRC_AT + 2 == DATA_PACKET_LENGTH
+              && DATA_PACKET_CRC_ORDER == PACKET_LSB_FIRST);
+PACKET_ASSERT(LOW_BATTERY_PACKET_CRC_LAST, LOW_BATTERY_PACKET_CRC_AT + 2 == LOW_BATTERY_PACKET_LENGTH
+              && LOW_BATTERY_PACKET_CRC_ORDER == PACKET_LSB_FIRST);
+
+//A packet goes straight into the radio's FIFO a field at a time, with the
+//CRC16 worked out on the way, so there is no copy of it in RAM:
+//packetBegin(), then PACKET_SEND() or PACKET_SEND_BYTES() for each field in
+//order, then PACKET_END() and LoRaTXStart().  A field left out is sent as
+//zeros, the CRC16 only with PACKET_CRC_SOFTWARE.  e.g. PACKET_SEND(DATA_PACKET, TIPS, tipCount)
+#define PACKET_SEND(format, name, value) \
+    packetNumber(format##_##name##_AT, format##_##name##_SIZE, format##_##name##_ORDER, (uint32_t)(value))
+#define PACKET_SEND_BYTES(format, name, data) \
+    packetBytes(format##_##name##_AT, (data), format##_##name##_SIZE)
+#define PACKET_END(format) packetEnd(format##_CRC_AT)
+
+void packetBegin(void);
+void packetNumber(uint8_t, uint8_t, uint8_t, uint32_t); //Offset, size, order, value
+void packetBytes(uint8_t, const uint8_t*, uint8_t); //Offset, bytes, how many
+uint8_t packetEnd(uint8_t); //Offset of the CRC16, returns the length sent
+
+#endif	/* INC_PACKET_H */
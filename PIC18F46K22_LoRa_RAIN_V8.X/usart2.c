@@ -1,7 +1,18 @@
 #include "usart2.h"
 #include "config.h"
+#include "hal.h"
 #include <stdint.h>
 
+#if (USART2_TX_BUFFER_SIZE & (USART2_TX_BUFFER_SIZE - 1)) || USART2_TX_BUFFER_SIZE > 128
+#error "USART2_TX_BUFFER_SIZE must be a power of 2 up to 128"
+#endif
+
+//Transmit ring buffer, emptied into TXREG2 by the TX2IF interrupt.
+//Only putch() moves txHead and only USART2_TXInterrupt() moves txTail.
+static volatile uint8_t txBuffer[USART2_TX_BUFFER_SIZE];
+static volatile uint8_t txHead = 0;
+static volatile uint8_t txTail = 0;
+
 //Configures serial port 2 8-bit
 /**
  * Configures USART2 for serial port use with the defined baud rate.
@@ -55,36 +66,71 @@ void USART2_Start(const uint8_t baudrate){
 
 //    PIR1bits.RC1IF=0; //Clear interrupt bit
 //    PIE1bits.RC1IE=1; //Enable UART1 receive interrupt
-//    INTCONbits.PEIE_GIEL=1; //Enable peripheral interrupts
+    PIE3bits.TX2IE=0; //Turned on by putch() when there is something to send
+    INTCONbits.PEIE_GIEL=1; //Enable peripheral interrupts
 //    INTCONbits.GIE_GIEH=1; //Enable global interrupts
 }
 
 /**
- * Puts a character into the transmit buffer of USART2 and waits for it to be transmitted.
+ * Puts a character into the transmit buffer of USART2.
  * @param data  The data byte to send.
  */
 void putchar(char data){
-  while(!TRMT2){
-      
-  }
-  TXREG2 = data;
-  //Wait here til transmit buffer is empty
-  while(!TRMT2){
-      
-  }
+    putch(data);
 }
 
 /**
- * Puts a character into the transmit buffer of USART2 and waits for it to be transmitted.
+ * Used while waiting on the ring buffer.  With interrupts off nothing else
+ * will empty it, so send the next byte from here when TXREG2 is free.
+ */
+static void USART2_TXPoll(){
+    if(HAL_UART2_TX_READY() && !INTCONbits.GIE){
+        USART2_TXInterrupt();
+    }
+}
+
+/**
+ * Queues a character for USART2 and returns straight away unless the ring
+ * buffer is full.  printf() sends its output through here.
  * @param data  The data byte to send.
  */
 void putch(char data){
-  while(!TRMT2){   
-  }
-  TXREG2 = data;
-  //Wait here until transmit buffer is empty
-  while(!TRMT2){   
-  }
+    while((uint8_t)(txHead - txTail) >= USART2_TX_BUFFER_SIZE){
+        USART2_TXPoll(); //Full, wait for a byte to go
+    }
+    txBuffer[txHead % USART2_TX_BUFFER_SIZE] = data;
+    txHead++;
+    PIE3bits.TX2IE=1; //TX2IF is set while TXREG2 is empty, so this starts sending
+}
+
+/**
+ * Moves the next byte from the ring buffer into TXREG2, which clears TX2IF.
+ * Turns the interrupt off once the buffer is empty.
+ */
+void USART2_TXInterrupt(){
+    if(txTail != txHead){
+        HAL_UART2_WRITE(txBuffer[txTail % USART2_TX_BUFFER_SIZE]);
+        txTail++;
+    }
+    if(txTail == txHead){
+        PIE3bits.TX2IE=0;
+    }
+}
+
+/**
+ * Waits until the ring buffer is empty and the last byte has left the shift
+ * register.  Must be called before SLEEP or turning the module off, as the
+ * baud rate generator stops in sleep.
+ */
+void USART2_Flush(){
+    if(PMD0bits.UART2MD || !TXSTA2bits.TXEN){
+        return; //Not running, nothing can have been sent
+    }
+    while(txTail != txHead){
+        USART2_TXPoll();
+    }
+    while(!HAL_UART2_TX_IDLE()){
+    }
 }
 
 /**
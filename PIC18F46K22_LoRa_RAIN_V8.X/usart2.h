@@ -18,9 +18,16 @@
 #include <xc.h> // include processor files - each processor file is guarded. 
 #include <stdint.h>
 
+#ifndef USART2_TX_BUFFER_SIZE
+#define USART2_TX_BUFFER_SIZE 64 //Transmit ring buffer, a power of 2 up to 128
+#endif
+
 void USART2_Start(const uint8_t);
 
 void putchar(char);
+void putch(char);
+void USART2_TXInterrupt(void); //Call from the ISR when TX2IE and TX2IF are set
+void USART2_Flush(void); //Waits until everything queued has been sent
 
 void USART2reset(void);
 
@@ -0,0 +1,148 @@
+/*
+ * File:   airtime.c
+ * Author: Andy Page
+ * Comments: Compares the common 50 byte packet with the compact format
+ * (compact.c) over a set of typical packets: length, time on air with the
+ * modem settings in LoRa.h, and the radio's share of the energy at 17dBm.
+ * The compact packets are made up by the firmware's own compactPacket(), and
+ * each one is decoded again to check it.
+ * Then the three PACKET_CRC modes (defines.h) for the common format: bytes
+ * sent, time on air, and the CPU's share of the check.
+ *
+ * Usage: packet-airtime
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "LoRa.h"
+#include "compact.h"
+#include "packet.h"
+
+//CRC16.c from the firmware, without CRC16.h as that includes xc.h
+unsigned short int CRC16(const unsigned char *, unsigned short int);
+
+#define TX_17DBM_MA 87.0 //PA_BOOST at 17dBm, as in radio.c
+#define VDD_V 3.0
+//Estimated from the CRC16_TABLE_256 loop in CRC16.c (fetch, XOR, two table
+//reads, shift, call and return), XC8 is not run here
+#define CRC16_CYCLES_PER_BYTE 30
+#define PIC_MIPS 16 //64MHz, 4 clocks an instruction
+#define CRC16_TABLE_BYTES 512 //CRC16_TABLE_256, 32 with CRC16_TABLE_16
+
+typedef struct {
+    const char *name;
+    uint8_t software; //CRC16 in the payload
+    uint8_t radio; //RxPayloadCrcOn
+} CRCMode;
+
+static const CRCMode crcModes[] = {
+    {"software (default)", 1, 0},
+    {"radio", 0, 1},
+    {"both", 1, 1},
+};
+
+typedef struct {
+    const char *name;
+    uint32_t message;
+    uint32_t tips;
+    uint8_t full;
+    uint8_t rained;
+    uint8_t carried; //Readings from the backlog or the history
+} Scenario;
+
+static const Scenario scenarios[] = {
+    {"first report after power on", 0, 0, 1, 0, 0},
+    {"dry report, first week", 2000, 0, 1, 0, 1},
+    {"dry report, after a year", 262000, 7500, 1, 0, 1},
+    {"rain window, after a year", 262100, 7600, 1, 1, 1},
+    {"rain window, after 10 years", 2620000, 75000, 1, 1, 1},
+    {"low battery packet", 262000, 7500, 0, 0, 0},
+};
+
+/**
+ * Reads a varint back.
+ */
+static const uint8_t *readVarint(const uint8_t *data, uint32_t *value){
+    unsigned shift = 0;
+    *value = 0;
+    do{
+        *value |= (uint32_t)(*data & 0x7F) << shift;
+        shift += 7;
+    }while(*data++ & 0x80);
+    return data;
+}
+
+/**
+ * Decodes the packet's counts again and checks them and its CRC16.
+ */
+static int check(const uint8_t *packet, uint8_t length, const Scenario *scenario){
+    unsigned short int crc = CRC16(packet, (unsigned short int)(length - 2));
+    if(packet[length-2] != (crc & 0xFF) || packet[length-1] != (crc >> 8)){
+        return 0;
+    }
+    uint32_t message;
+    uint32_t tips;
+    readVarint(readVarint(&packet[3], &message), &tips);
+    uint8_t carried = (packet[0] & COMPACT_CARRIED_MASK) >> COMPACT_CARRIED_SHIFT;
+    return (packet[0] & COMPACT_FORMAT_MASK) == COMPACT_FORMAT && message == scenario->message
+        && tips == scenario->tips && carried == scenario->carried;
+}
+
+int main(void){
+    static const uint8_t address[8] = {0xE6,0xBA,0x08,0xFB,0x3A,0x4F,0x5E,0xCE};
+    uint16_t hash = compactAddressHash(0x00, 0x01, address);
+    int errors = 0;
+
+    printf("modem            SF%u, %lu Hz, CR 4/%u, preamble %u\n",
+           LORA_SF, LORA_BW_HZ(LORA_BW), LORA_CR + 4, LORA_PREAMBLE);
+    printf("%-30s %13s %13s %8s %11s\n", "", "common", "compact", "airtime", "radio at");
+    printf("%-30s %4s %8s %4s %8s %8s %11s\n", "packet", "B", "ms", "B", "ms", "saved", "17dBm uJ");
+    for(unsigned i=0;i<sizeof(scenarios)/sizeof(*scenarios);i++){
+        const Scenario *scenario = &scenarios[i];
+        uint8_t readings[COMPACT_CARRIED * BACKLOG_PACKED] = {0};
+        static const uint8_t histogram[COMPACT_HISTOGRAM_BYTES] = {0x51, 0x45, 0x11, 0x45};
+        if(scenario->carried){
+            readings[0] = 1; //The reading before, 3 tips earlier
+            readings[1] = 0x00;
+            readings[2] = 0x3B;
+            readings[3] = 0xB6;
+            readings[4] = 0x00;
+        }
+        uint8_t packet[COMPACT_MAX_LENGTH];
+        uint8_t length = compactPacket(packet, hash, scenario->message, scenario->tips, 749,
+                                       scenario->full ? 512 : COMPACT_NO_TEMPERATURE,
+                                       scenario->rained ? histogram : 0, readings, COMPACT_CARRIED);
+        if(!check(packet, length, scenario)){
+            printf("%s: compact packet does not decode\n", scenario->name);
+            errors++;
+        }
+        uint8_t commonLength = scenario->full ? DATA_PACKET_LENGTH : LOW_BATTERY_PACKET_LENGTH;
+        double common_ms = LORA_TIME_ON_AIR_US(commonLength) / 1000.0;
+        double compact_ms = LORA_TIME_ON_AIR_US(length) / 1000.0;
+        printf("%-30s %4u %8.3f %4u %8.3f %7.1f%% %5.0f %5.0f\n", scenario->name,
+               commonLength, common_ms, length, compact_ms, (common_ms - compact_ms) * 100 / common_ms,
+               common_ms * TX_17DBM_MA * VDD_V, compact_ms * TX_17DBM_MA * VDD_V);
+    }
+    printf("longest compact  %u bytes, %.3f ms on air\n",
+           COMPACT_MAX_LENGTH, LORA_TIME_ON_AIR_US(COMPACT_MAX_LENGTH) / 1000.0);
+
+    printf("%-30s %13s %13s %14s\n", "PACKET_CRC", "full", "low battery", "CRC16 per");
+    printf("%-30s %4s %8s %4s %8s %5s %8s\n", "", "B", "ms", "B", "ms", "bytes", "us (est)");
+    for(unsigned i=0;i<sizeof(crcModes)/sizeof(*crcModes);i++){
+        const CRCMode *mode = &crcModes[i];
+        uint8_t full = DATA_PACKET_LENGTH - 2 + 2 * mode->software;
+        uint8_t low = LOW_BATTERY_PACKET_LENGTH - 2 + 2 * mode->software;
+        unsigned crcBytes = mode->software ? DATA_PACKET_LENGTH - 2 : 0; //CRC16Update() calls
+        printf("%-30s %4u %8.3f %4u %8.3f %5u %8.1f\n", mode->name,
+               full, LORA_AIRTIME_US(LORA_SF, LORA_BW_HZ(LORA_BW), LORA_CR, LORA_PREAMBLE,
+                                     LORA_IMPLICIT_HEADER, mode->radio, full) / 1000.0,
+               low, LORA_AIRTIME_US(LORA_SF, LORA_BW_HZ(LORA_BW), LORA_CR, LORA_PREAMBLE,
+                                    LORA_IMPLICIT_HEADER, mode->radio, low) / 1000.0,
+               crcBytes, (double)crcBytes * CRC16_CYCLES_PER_BYTE / PIC_MIPS);
+    }
+    printf("CRC16 table      %u bytes of flash in every mode, journal.c and the compact format use it too\n"
+           "                 (CRC16_METHOD in CRC16.h trades it for time, see crc16-bench)\n",
+           CRC16_TABLE_BYTES);
+    return errors ? 1 : 0;
+}
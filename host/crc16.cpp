@@ -0,0 +1,321 @@
+/**
+ * crc16.cpp
+ * The firmware's CRC16 a byte, 8 bytes or 64 bytes at a time, see crc16.hpp
+ */
+
+#include "crc16.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define HAVE_CLMUL 1
+#define CLMUL_TARGET __attribute__((target("pclmul,sse2")))
+#else
+#define HAVE_CLMUL 0
+#endif
+
+namespace crc16 {
+namespace {
+
+constexpr std::uint16_t POLYNOMIAL = 0xA001; //0x8005 reflected, as CRC16.c
+constexpr std::size_t SLICES = 8;
+
+struct Tables {
+    std::uint16_t slice[SLICES][256]; //slice[k][b] is the CRC16 of b then k zero bytes, from 0
+};
+
+constexpr Tables makeTables(){
+    Tables tables{};
+    for(unsigned i=0;i<256;i++){
+        std::uint16_t crc = (std::uint16_t)i;
+        for(int bit=0;bit<8;bit++){
+            crc = (crc & 1) ? (std::uint16_t)((crc >> 1) ^ POLYNOMIAL) : (std::uint16_t)(crc >> 1);
+        }
+        tables.slice[0][i] = crc;
+    }
+    for(std::size_t k=1;k<SLICES;k++){
+        for(unsigned i=0;i<256;i++){
+            std::uint16_t crc = tables.slice[k-1][i];
+            tables.slice[k][i] = (std::uint16_t)((crc >> 8) ^ tables.slice[0][crc & 0xFF]);
+        }
+    }
+    return tables;
+}
+
+constexpr Tables TABLES = makeTables();
+static_assert(TABLES.slice[0][1] == 0xC0C1 && TABLES.slice[0][255] == 0x4040, "the table in CRC16.c");
+
+std::uint16_t bytewise(const std::uint8_t *data, std::size_t length, std::uint16_t crc){
+    while(length--){
+        crc = (std::uint16_t)((crc >> 8) ^ TABLES.slice[0][(std::uint8_t)(*data++ ^ crc)]);
+    }
+    return crc;
+}
+
+std::uint16_t slicing8(const std::uint8_t *data, std::size_t length, std::uint16_t crc){
+    const auto &slice = TABLES.slice;
+    while(length >= 8){
+        //The CRC so far goes over the first two bytes, each byte is then
+        //looked up as if followed by the rest of the 8
+        std::uint32_t low = (std::uint32_t)(data[0] | data[1] << 8) ^ crc;
+        crc = (std::uint16_t)(slice[7][low & 0xFF] ^ slice[6][low >> 8] ^ slice[5][data[2]] ^ slice[4][data[3]]
+                              ^ slice[3][data[4]] ^ slice[2][data[5]] ^ slice[1][data[6]] ^ slice[0][data[7]]);
+        data += 8;
+        length -= 8;
+    }
+    return bytewise(data, length, crc);
+}
+
+#if HAVE_CLMUL
+//The folding works on the CRC16 as a 32 bit CRC with the polynomial times
+//x^16, which leaves the CRC16 in the low half.  Each 128 bit block is
+//carried forward by multiplying its two halves by x^n mod that polynomial,
+//reflected as the data is.  The product comes out 33 bits along, hence the
+//-33 in each power.
+constexpr std::uint32_t xPowerMod(unsigned n){
+    constexpr std::uint64_t POLYNOMIAL_32 = 0x180050000ull; //x^16 (x^16 + x^15 + x^2 + 1)
+    std::uint64_t remainder = 1;
+    while(n--){
+        remainder <<= 1;
+        if(remainder >> 32){
+            remainder ^= POLYNOMIAL_32;
+        }
+    }
+    std::uint32_t reflected = 0;
+    for(int bit=0;bit<32;bit++){
+        if(remainder >> bit & 1){
+            reflected |= 1u << (31 - bit);
+        }
+    }
+    return reflected;
+}
+
+//floor(x^64 / the polynomial), 33 bits reflected, for the Barrett reduction
+constexpr std::uint64_t barrettMu(){
+    constexpr unsigned __int128 POLYNOMIAL_32 = 0x180050000ull;
+    unsigned __int128 remainder = (unsigned __int128)1 << 64;
+    std::uint64_t quotient = 0;
+    for(int degree=64;degree>=32;degree--){
+        if((std::uint64_t)(remainder >> degree) & 1){
+            quotient |= 1ull << (degree - 32);
+            remainder ^= POLYNOMIAL_32 << (degree - 32);
+        }
+    }
+    std::uint64_t reflected = 0;
+    for(int bit=0;bit<=32;bit++){
+        if(quotient >> bit & 1){
+            reflected |= 1ull << (32 - bit);
+        }
+    }
+    return reflected;
+}
+
+constexpr std::uint32_t FOLD_16_LOW = xPowerMod(128 + 64 - 33); //16 bytes on
+constexpr std::uint32_t FOLD_16_HIGH = xPowerMod(128 - 33);
+constexpr std::uint32_t FOLD_64_LOW = xPowerMod(512 + 64 - 33); //64 bytes on
+constexpr std::uint32_t FOLD_64_HIGH = xPowerMod(512 - 33);
+constexpr std::uint32_t REDUCE_128 = xPowerMod(96 - 1); //128 bits to 96
+constexpr std::uint32_t REDUCE_96 = xPowerMod(64 - 1); //96 bits to 64
+constexpr std::uint64_t BARRETT_MU = barrettMu(); //64 bits to the CRC
+constexpr std::uint64_t BARRETT_POLYNOMIAL = 0xA001ull << 1; //Less x^32, 33 bits reflected
+constexpr std::size_t CLMUL_MIN = 32; //Shorter goes to slicing8()
+constexpr std::size_t BATCH = 8; //Packets verify() folds at once, 8 keeps the multiplier busy
+
+CLMUL_TARGET inline __m128i load(const std::uint8_t *data){
+    return _mm_loadu_si128((const __m128i *)data);
+}
+
+CLMUL_TARGET inline __m128i fold(__m128i block, __m128i constants, __m128i next){
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(block, constants, 0x00),
+                                       _mm_clmulepi64_si128(block, constants, 0x11)), next);
+}
+
+CLMUL_TARGET inline std::uint64_t multiply(std::uint64_t a, std::uint64_t b){
+    return (std::uint64_t)_mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)a),
+                                                                 _mm_cvtsi64_si128((long long)b), 0x00));
+}
+
+/**
+ * The CRC16 of what has been folded into block, then of the bytes left.
+ * The block is brought down to 64 bits with two more folds and then to the
+ * CRC by Barrett reduction, rather than run through the tables.
+ */
+CLMUL_TARGET std::uint16_t finish(__m128i block, const std::uint8_t *data, std::size_t length){
+    //The low half times x^96, the high half times x^32: 96 bits
+    __m128i folded = _mm_xor_si128(_mm_clmulepi64_si128(block, _mm_cvtsi32_si128((int)REDUCE_128), 0x00),
+                                   _mm_srli_si128(block, 8));
+    //Its first 32 bits times x^64: 64 bits
+    std::uint64_t first = (std::uint64_t)_mm_cvtsi128_si64(folded);
+    std::uint64_t rest = (std::uint64_t)_mm_cvtsi128_si64(_mm_srli_si128(folded, 4));
+    std::uint64_t y = rest ^ multiply(first & 0xFFFFFFFF, REDUCE_96);
+    //Barrett: the quotient from the first 32 bits, the remainder is what the
+    //quotient times the polynomial leaves of the last 32
+    std::uint64_t quotient = multiply(y & 0xFFFFFFFF, BARRETT_MU) & 0xFFFFFFFF;
+    std::uint32_t crc = (std::uint32_t)((y >> 32) ^ (multiply(quotient, BARRETT_POLYNOMIAL) >> 32));
+    return slicing8(data, length, (std::uint16_t)crc);
+}
+
+CLMUL_TARGET std::uint16_t clmul(const std::uint8_t *data, std::size_t length, std::uint16_t crc){
+    if(length < CLMUL_MIN){
+        return slicing8(data, length, crc);
+    }
+    const __m128i fold16 = _mm_set_epi64x(FOLD_16_HIGH, FOLD_16_LOW);
+    __m128i x0 = _mm_xor_si128(load(data), _mm_cvtsi32_si128(crc));
+    data += 16;
+    length -= 16;
+    if(length >= 48){
+        //Four blocks folded side by side, then into one
+        const __m128i fold64 = _mm_set_epi64x(FOLD_64_HIGH, FOLD_64_LOW);
+        __m128i x1 = load(data);
+        __m128i x2 = load(data + 16);
+        __m128i x3 = load(data + 32);
+        data += 48;
+        length -= 48;
+        while(length >= 64){
+            x0 = fold(x0, fold64, load(data));
+            x1 = fold(x1, fold64, load(data + 16));
+            x2 = fold(x2, fold64, load(data + 32));
+            x3 = fold(x3, fold64, load(data + 48));
+            data += 64;
+            length -= 64;
+        }
+        x0 = fold(fold(fold(x0, fold16, x1), fold16, x2), fold16, x3);
+    }
+    while(length >= 16){
+        x0 = fold(x0, fold16, load(data));
+        data += 16;
+        length -= 16;
+    }
+    return finish(x0, data, length);
+}
+
+/**
+ * clmul() of BATCH packets of the same length at once, each folding while
+ * the others wait on the multiplier.
+ * @param length  At least CLMUL_MIN
+ */
+CLMUL_TARGET void clmulBatch(const std::uint8_t *frames, std::size_t stride, std::size_t length,
+                             std::uint16_t *crcs){
+    const __m128i fold16 = _mm_set_epi64x(FOLD_16_HIGH, FOLD_16_LOW);
+    const __m128i init = _mm_cvtsi32_si128(INIT);
+    __m128i x[BATCH];
+    for(std::size_t i=0;i<BATCH;i++){
+        x[i] = _mm_xor_si128(load(frames + i * stride), init);
+    }
+    std::size_t at = 16;
+    for(;at+16<=length;at+=16){
+        for(std::size_t i=0;i<BATCH;i++){
+            x[i] = fold(x[i], fold16, load(frames + i * stride + at));
+        }
+    }
+    for(std::size_t i=0;i<BATCH;i++){
+        crcs[i] = finish(x[i], frames + i * stride + at, length - at);
+    }
+}
+#endif
+
+using Function = std::uint16_t (*)(const std::uint8_t *, std::size_t, std::uint16_t);
+
+Function function(Method method){
+    switch(method){
+        case Method::BYTEWISE:
+            return bytewise;
+#if HAVE_CLMUL
+        case Method::CLMUL:
+            if(supported(Method::CLMUL)){
+                return clmul;
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+    return slicing8;
+}
+
+/**
+ * Sets ok for one packet.
+ * @return 1 if crc matches the CRC16 at its end
+ */
+std::size_t check(const std::uint8_t *frame, std::size_t length, std::uint16_t crc, std::uint8_t *ok){
+    std::uint8_t passed = frame[length-2] == (crc & 0xFF) && frame[length-1] == (crc >> 8);
+    if(ok){
+        *ok = passed;
+    }
+    return passed;
+}
+
+} // namespace
+
+const char *name(Method method){
+    switch(method){
+        case Method::BYTEWISE:
+            return "bytewise";
+        case Method::SLICING_8:
+            return "slicing-by-8";
+        case Method::CLMUL:
+            return "pclmulqdq";
+    }
+    return "?";
+}
+
+bool supported(Method method){
+    if(method != Method::CLMUL){
+        return true;
+    }
+#if HAVE_CLMUL
+    static const bool clmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2");
+    return clmul;
+#else
+    return false;
+#endif
+}
+
+Method fastest(){
+    return supported(Method::CLMUL) ? Method::CLMUL : Method::SLICING_8;
+}
+
+std::uint16_t compute(const std::uint8_t *data, std::size_t length, std::uint16_t crc){
+    static const Function best = function(fastest());
+    return best(data, length, crc);
+}
+
+std::uint16_t compute(Method method, const std::uint8_t *data, std::size_t length, std::uint16_t crc){
+    return function(method)(data, length, crc);
+}
+
+std::size_t verify(const std::uint8_t *frames, std::size_t count, std::size_t stride, std::size_t length,
+                   std::uint8_t *ok){
+    static const Method best = fastest();
+    return verify(best, frames, count, stride, length, ok);
+}
+
+std::size_t verify(Method method, const std::uint8_t *frames, std::size_t count, std::size_t stride,
+                   std::size_t length, std::uint8_t *ok){
+    std::size_t passed = 0;
+    std::size_t i = 0;
+    if(length < 2){
+        for(;ok && i<count;i++){
+            ok[i] = 0;
+        }
+        return 0;
+    }
+#if HAVE_CLMUL
+    if(method == Method::CLMUL && supported(Method::CLMUL) && length - 2 >= CLMUL_MIN){
+        std::uint16_t crcs[BATCH];
+        for(;i+BATCH<=count;i+=BATCH){
+            clmulBatch(frames + i * stride, stride, length - 2, crcs);
+            for(std::size_t j=0;j<BATCH;j++){
+                passed += check(frames + (i + j) * stride, length, crcs[j], ok ? ok + i + j : nullptr);
+            }
+        }
+    }
+#endif
+    Function crc16 = function(method);
+    for(;i<count;i++){
+        const std::uint8_t *frame = frames + i * stride;
+        passed += check(frame, length, crc16(frame, length - 2, INIT), ok ? ok + i : nullptr);
+    }
+    return passed;
+}
+
+} // namespace crc16
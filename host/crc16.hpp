@@ -0,0 +1,62 @@
+/*
+ * File:   crc16.hpp
+ * Author: Andy Page
+ * Comments: The firmware's CRC16 (CRC16.c, the Modbus one) for the gateway
+ * and for checking archives of packets, where it runs over far more bytes
+ * than the gauge ever sends.  Same results as CRC16(), by any of three
+ * methods:
+ *   BYTEWISE   the 256 entry table a byte at a time, as CRC16.c
+ *   SLICING_8  eight 256 entry tables, 8 bytes a step
+ *   CLMUL      carry-less multiply (PCLMULQDQ), folding 64 bytes a step,
+ *              only on x86-64 processors that have it
+ * compute() and verify() use the fastest one the processor has, picked
+ * once at startup; pass a Method to choose.  verify() checks a batch of
+ * packets of the same length in one call, several at once, which hides
+ * the latency of each.  crc16-throughput checks them all against CRC16.c
+ * and measures them.
+ *
+ *   if(crc16::compute(packet, length - 2) == (packet[length-2] | packet[length-1] << 8)) ...
+ *   size_t good = crc16::verify(frames, count, 64, 50, ok);
+ *
+ * Revision history: 1, 15th October 2026
+ */
+
+#ifndef INC_CRC16_HPP
+#define INC_CRC16_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace crc16 {
+
+constexpr std::uint16_t INIT = 0xFFFF; //CRC16_INIT, the CRC16 of no bytes
+
+enum class Method { BYTEWISE, SLICING_8, CLMUL };
+constexpr Method METHODS[] = { Method::BYTEWISE, Method::SLICING_8, Method::CLMUL };
+
+const char *name(Method);
+bool supported(Method); //By this processor
+Method fastest(); //What compute() and verify() use
+
+/**
+ * CRC16 of length bytes, carrying on from crc.
+ * @param crc  INIT for a new CRC16, or what an earlier call returned
+ */
+std::uint16_t compute(const std::uint8_t *data, std::size_t length, std::uint16_t crc = INIT);
+std::uint16_t compute(Method, const std::uint8_t *data, std::size_t length, std::uint16_t crc = INIT);
+
+/**
+ * Checks count packets, each ending in its CRC16 LSB first.
+ * @param frames  The first packet, each one stride bytes after the last
+ * @param length  Bytes in each packet, the CRC16 included
+ * @param ok  Set to 1 for each packet that passes, 0 otherwise; may be null
+ * @return How many passed
+ */
+std::size_t verify(const std::uint8_t *frames, std::size_t count, std::size_t stride, std::size_t length,
+                   std::uint8_t *ok);
+std::size_t verify(Method, const std::uint8_t *frames, std::size_t count, std::size_t stride,
+                   std::size_t length, std::uint8_t *ok);
+
+} // namespace crc16
+
+#endif /* INC_CRC16_HPP */
@@ -0,0 +1,125 @@
+/*
+ * File:   crcbench.c
+ * Author: Andy Page
+ * Comments: Checks that the CRC16_METHOD choices in the firmware's CRC16.c
+ * all give the same CRC16, and compares their table size and speed.
+ * CRC16.c is built once per method, with its functions renamed on the
+ * command line (see host/Makefile), so all three are linked in together.
+ * Each is checked against the Modbus check value for "123456789" (0x4B37),
+ * against the 256 entry table over random buffers of every length up to
+ * 300 bytes, and CRC16Update() a byte at a time against CRC16().
+ * Speed is measured on the host over 48 byte packets, so it only shows how
+ * the methods compare; the PIC has no cache and no barrel shifter, which
+ * widens the gap.
+ *
+ * Usage: crc16-bench [-m MB]
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+//CRC16.c from the firmware for each CRC16_METHOD, without CRC16.h as that
+//includes xc.h
+#define CRC16_INIT 0xFFFF
+#define METHOD(name) \
+    unsigned short int CRC16_##name(const unsigned char *, unsigned short int); \
+    unsigned short int CRC16Update_##name(unsigned short int, unsigned char);
+METHOD(table256)
+METHOD(table16)
+METHOD(bitwise)
+
+#define PACKET_BYTES 48 //CRC16 of the full packet
+#define CHECK_LENGTHS 300
+
+typedef struct {
+    const char *name;
+    unsigned tableBytes; //wCRCTable in CRC16.c
+    unsigned short int (*crc)(const unsigned char *, unsigned short int);
+    unsigned short int (*update)(unsigned short int, unsigned char);
+} Method;
+
+static const Method methods[] = {
+    {"CRC16_TABLE_256", 512, CRC16_table256, CRC16Update_table256},
+    {"CRC16_TABLE_16", 32, CRC16_table16, CRC16Update_table16},
+    {"CRC16_BITWISE", 0, CRC16_bitwise, CRC16Update_bitwise},
+};
+
+#define METHODS (sizeof(methods)/sizeof(*methods))
+
+static double now_s(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ * @return Mismatches against the 256 entry table and the check value
+ */
+static unsigned check(const Method *method){
+    static const unsigned char checkString[] = "123456789";
+    unsigned errors = method->crc(checkString, 9) != 0x4B37;
+    unsigned char data[CHECK_LENGTHS];
+    srand(1);
+    for(unsigned length=0;length<=CHECK_LENGTHS;length++){
+        for(unsigned i=0;i<length;i++){
+            data[i] = (unsigned char)rand();
+        }
+        unsigned short int crc = method->crc(data, (unsigned short int)length);
+        unsigned short int byByte = CRC16_INIT;
+        for(unsigned i=0;i<length;i++){
+            byByte = method->update(byByte, data[i]);
+        }
+        errors += crc != CRC16_table256(data, (unsigned short int)length) || byByte != crc;
+    }
+    return errors;
+}
+
+int main(int argc, char **argv){
+    double megabytes = 64;
+    int option;
+
+    while((option = getopt(argc, argv, "m:")) != -1){
+        switch(option){
+            case 'm':
+                megabytes = atof(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-m MB]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    unsigned char packet[PACKET_BYTES];
+    for(unsigned i=0;i<PACKET_BYTES;i++){
+        packet[i] = (unsigned char)(i * 37 + 11);
+    }
+    unsigned long packets = (unsigned long)(megabytes * 1e6 / PACKET_BYTES);
+    unsigned errors = 0;
+    double fastest = 0;
+
+    printf("%-16s %6s %7s %9s  %s\n", "CRC16_METHOD", "table", "ns per", "relative", "same CRC16");
+    printf("%-16s %6s %7s %9s\n", "", "bytes", "byte", "time");
+    for(unsigned m=0;m<METHODS;m++){
+        const Method *method = &methods[m];
+        unsigned mismatches = check(method);
+        errors += mismatches;
+        volatile unsigned short int crc = 0; //Keeps the work
+        double start = now_s();
+        for(unsigned long i=0;i<packets;i++){
+            crc ^= method->crc(packet, PACKET_BYTES);
+        }
+        double ns = (now_s() - start) * 1e9 / ((double)packets * PACKET_BYTES);
+        if(m == 0){
+            fastest = ns;
+        }
+        printf("%-16s %6u %7.2f %8.1fx  %s\n", method->name, method->tableBytes, ns, ns / fastest,
+               mismatches ? "NO" : "yes");
+    }
+    printf("checked          \"123456789\" is 0x4B37, and lengths 0 to %u against CRC16_TABLE_256 and CRC16Update()\n",
+           CHECK_LENGTHS);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,348 @@
+/*
+ * File:   decode.cpp
+ * Author: Andy Page
+ * Comments: Gateway side decoder for the rain gauge packets.  Checks the
+ * CRC16, takes the reading from each packet and the readings carried in its
+ * data area (bytes 28 to 47, see backlog.h), and merges them into one series
+ * by message count, with the tip histogram of the window from each full
+ * packet (bytes 20 to 23, 16 buckets of 2 bits).  Readings from missed packets are rebuilt from the ones
+ * that carried them, so the series has gaps only where every copy was lost.
+ * The common format is read in place through packet.hpp, so the field
+ * offsets come from the firmware's packet.h rather than being copied here.
+ * Packets in the compact format (compact.h) are decoded too, told apart by
+ * their first byte.  The CRC16 is checked with the host library (crc16.hpp).
+ * Packets are read as hex bytes, one per line; anything up to a ':' is
+ * skipped, so the -p output of raingauge-sim can be piped straight in.  A
+ * packet sent with the radio's payload CRC (PACKET_CRC_RADIO) is followed by
+ * "crc" and the CRC in hex, which is checked as the receiving radio would
+ * (loracrc.h).  A packet in either format must pass the CRC16, the radio's
+ * CRC or both, whichever it was sent with.
+ *
+ * Usage: packet-decode [-d n] [-f n] [-q] [file]
+ *   -d  drop every nth packet first, as a gateway that misses some
+ *   -f  flip a bit in every nth packet, to see that each one is caught
+ *   -q  print the totals only, not the series
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "packet.hpp"
+#include "loracrc.h"
+#include "compact.h"
+
+#define NO_TEMPERATURE 0xFFFF //The low battery packet has none
+#define HISTOGRAM_BUCKETS 16
+
+typedef struct {
+    uint32_t message;
+    uint32_t tips;
+    uint16_t battery;
+    uint16_t temperature;
+    uint8_t direct; //From its own packet rather than carried in a later one
+    uint8_t hasHistogram;
+    uint32_t histogram; //Bucket 0 in the top 2 bits
+} Reading;
+
+static Reading *series;
+static size_t seriesLength;
+static size_t seriesSize;
+
+static Reading *add(uint32_t message, uint32_t tips, uint16_t battery, uint16_t temperature, uint8_t direct){
+    if(seriesLength == seriesSize){
+        seriesSize = seriesSize ? seriesSize * 2 : 256;
+        series = (Reading *)realloc(series, seriesSize * sizeof(*series));
+        if(!series){
+            perror("packet-decode");
+            exit(1);
+        }
+    }
+    Reading *reading = &series[seriesLength++];
+    reading->message = message;
+    reading->tips = tips;
+    reading->battery = battery;
+    reading->temperature = temperature;
+    reading->direct = direct;
+    reading->hasHistogram = 0;
+    return reading;
+}
+
+static uint32_t be32(const uint8_t *p){
+    return (uint32_t)p[0]<<24 | (uint32_t)p[1]<<16 | (uint32_t)p[2]<<8 | p[3];
+}
+
+/**
+ * Sorts by message count, and puts the best copy of each reading first: one
+ * with a temperature, then one from its own packet, then one with a histogram.
+ */
+static int compare(const void *a, const void *b){
+    const Reading *x = (const Reading *)a;
+    const Reading *y = (const Reading *)b;
+    if(x->message != y->message){
+        return x->message < y->message ? -1 : 1;
+    }
+    if((x->temperature == NO_TEMPERATURE) != (y->temperature == NO_TEMPERATURE)){
+        return x->temperature == NO_TEMPERATURE ? 1 : -1;
+    }
+    if(x->direct != y->direct){
+        return (int)y->direct - (int)x->direct;
+    }
+    return (int)y->hasHistogram - (int)x->hasHistogram;
+}
+
+/**
+ * Adds the readings carried in a packet.  The firmware never sends 0 messages
+ * since for a reading (age() in backlog.c), so the first 0 ends them, and
+ * never sends either count all ones, which firmware that clamped them did for
+ * a reading too old to date.
+ */
+static void addCarried(const uint8_t *entry, unsigned count, uint32_t message, uint32_t tips){
+    for(unsigned i=0;i<count;i++,entry+=BACKLOG_PACKED){
+        if(entry[0] == 0){
+            break; //Zeros to the end
+        }
+        uint32_t packed = be32(&entry[1]);
+        uint32_t tipsSince = packed >> BACKLOG_TIPS_SHIFT;
+        if(entry[0] == BACKLOG_MESSAGES_SATURATED || tipsSince == BACKLOG_TIPS_SATURATED){
+            continue; //Saturated, the date is not known
+        }
+        add(message - entry[0], tips - tipsSince,
+            (uint16_t)((packed >> BACKLOG_BATTERY_SHIFT) & BACKLOG_READING_MASK),
+            (uint16_t)(packed & BACKLOG_READING_MASK), 0);
+    }
+}
+
+/**
+ * Reads a varint, see compact.h.
+ * @return Where the next field starts, or 0 if it runs past end
+ */
+static const uint8_t *varint(const uint8_t *data, const uint8_t *end, uint32_t *value){
+    *value = 0;
+    for(unsigned shift=0;data<end && shift<35;shift+=7){
+        *value |= (uint32_t)(*data & 0x7F) << shift;
+        if(!(*data++ & 0x80)){
+            return data;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Decodes a packet in the compact format into the series.
+ * @param crcBytes  2 if it ends in the CRC16, 0 if it was sent without
+ * @return 0 if it does not hold together
+ */
+static int decodeCompact(const uint8_t *packet, unsigned length, unsigned crcBytes){
+    const uint8_t *end = packet + length - crcBytes;
+    uint8_t header = packet[0];
+    uint32_t message;
+    uint32_t tips;
+    const uint8_t *data = varint(&packet[3], end, &message);
+    if(!data || !(data = varint(data, end, &tips))){
+        return 0;
+    }
+    unsigned carried = (header & COMPACT_CARRIED_MASK) >> COMPACT_CARRIED_SHIFT;
+    unsigned needed = (header & COMPACT_TEMPERATURE ? 3 : 2) + (header & COMPACT_HISTOGRAM ? COMPACT_HISTOGRAM_BYTES : 0)
+        + carried * BACKLOG_PACKED;
+    if(data + needed != end){
+        return 0;
+    }
+    Reading *reading;
+    if(header & COMPACT_TEMPERATURE){
+        uint32_t readings = (uint32_t)data[0]<<16 | (uint32_t)data[1]<<8 | data[2];
+        reading = add(message, tips, (uint16_t)(readings >> BACKLOG_BATTERY_SHIFT & BACKLOG_READING_MASK),
+                      (uint16_t)(readings & BACKLOG_READING_MASK), 1);
+        reading->hasHistogram = 1; //All zeros unless it rained
+        reading->histogram = 0;
+        data += 3;
+    }
+    else{
+        reading = add(message, tips, (uint16_t)(data[0]<<8 | data[1]), NO_TEMPERATURE, 1);
+        data += 2;
+    }
+    if(header & COMPACT_HISTOGRAM){
+        reading->histogram = be32(data);
+        data += COMPACT_HISTOGRAM_BYTES;
+    }
+    addCarried(data, carried, message, tips);
+    return 1;
+}
+
+/**
+ * Decodes one packet into the series.
+ * @param radioChecked  The radio's payload CRC came with it and was right
+ * @return 0 if it is not a whole rain gauge packet
+ */
+static int decode(const uint8_t *packet, unsigned length, bool radioChecked){
+    if(length < 5){
+        return 0;
+    }
+    if((packet[0] & COMPACT_FORMAT_MASK) == COMPACT_FORMAT){
+        //Without a length byte the layout only holds together one way, with
+        //the CRC16 on the end or without it
+        if(radioChecked && decodeCompact(packet, length, 0)){
+            return 1;
+        }
+        uint16_t crc = crc16::compute(packet, length - 2);
+        if(packet[length-2] != (crc & 0xFF) || packet[length-1] != (crc >> 8)){
+            return 0;
+        }
+        return decodeCompact(packet, length, 2);
+    }
+    packet::View<packet::LowBattery> lowBattery(packet);
+    if(lowBattery.valid(length, radioChecked)){
+        using Field = packet::LowBattery;
+        add(lowBattery.get<Field::MESSAGE>(), lowBattery.get<Field::TIPS>(),
+            (uint16_t)lowBattery.get<Field::BATTERY>(), NO_TEMPERATURE, 1);
+        return 1;
+    }
+    packet::View<packet::Data> data(packet);
+    if(!data.valid(length, radioChecked)){
+        return 0;
+    }
+    using Field = packet::Data;
+    uint32_t message = data.get<Field::MESSAGE>();
+    uint32_t tips = data.get<Field::TIPS>();
+    Reading *reading = add(message, tips, (uint16_t)data.get<Field::BATTERY>(),
+                           (uint16_t)data.get<Field::TEMPERATURE>(), 1);
+    reading->hasHistogram = 1;
+    reading->histogram = data.get<Field::HISTOGRAM>();
+    auto carried = data.get<Field::CARRIED>();
+    addCarried(carried.data(), carried.size() / BACKLOG_PACKED, message, tips);
+    return 1;
+}
+
+int main(int argc, char **argv){
+    unsigned dropEvery = 0;
+    unsigned flipEvery = 0;
+    int quiet = 0;
+    int option;
+
+    while((option = getopt(argc, argv, "d:f:q")) != -1){
+        switch(option){
+            case 'd':
+                dropEvery = (unsigned)atoi(optarg);
+                break;
+            case 'f':
+                flipEvery = (unsigned)atoi(optarg);
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-d n] [-f n] [-q] [file]\n", argv[0]);
+                return 1;
+        }
+    }
+    FILE *in = stdin;
+    if(optind < argc && !(in = fopen(argv[optind], "r"))){
+        perror(argv[optind]);
+        return 1;
+    }
+
+    char line[1024];
+    unsigned packets = 0;
+    unsigned dropped = 0;
+    unsigned bad = 0;
+    unsigned flipped = 0;
+    unsigned flippedBad = 0;
+    unsigned radioChecked = 0;
+    while(fgets(line, sizeof(line), in)){
+        char *hex = strchr(line, ':');
+        hex = hex ? hex + 1 : line;
+        unsigned long radioCRC = 0;
+        bool hasRadioCRC = false;
+        char *end;
+        char *crc = strstr(hex, " crc "); //c is a hex digit, so split it off first
+        if(crc){
+            *crc = 0;
+            radioCRC = strtoul(crc + 5, &end, 16);
+            hasRadioCRC = end != crc + 5;
+            if(strspn(end, " \t\r\n") != strlen(end)){
+                continue;
+            }
+        }
+        uint8_t packet[256];
+        unsigned length = 0;
+        unsigned long byte;
+        while(length < sizeof(packet) && (byte = strtoul(hex, &end, 16), end != hex)){
+            packet[length++] = (uint8_t)byte;
+            hex = end;
+        }
+        while(*hex == ' ' || *hex == '\t' || *hex == '\r' || *hex == '\n'){
+            hex++;
+        }
+        if(length == 0 || *hex){
+            continue; //Not a packet line
+        }
+        packets++;
+        if(dropEvery && packets % dropEvery == 0){
+            dropped++;
+            continue;
+        }
+        bool flip = flipEvery && packets % flipEvery == 0;
+        if(flip){
+            packet[packets / flipEvery * 7 % length] ^= (uint8_t)(1 << packets % 8); //Hit on air
+            flipped++;
+        }
+        //As the receiving radio does, before the gateway sees the packet
+        bool radioGood = hasRadioCRC && loraPayloadCRC(packet, length) == radioCRC;
+        radioChecked += radioGood;
+        if((hasRadioCRC && !radioGood) || !decode(packet, length, radioGood)){
+            bad++;
+            flippedBad += flip;
+        }
+    }
+
+    qsort(series, seriesLength, sizeof(*series), compare);
+    unsigned direct = 0;
+    unsigned rebuilt = 0;
+    unsigned noTemperature = 0;
+    unsigned gaps = 0;
+    if(!quiet){
+        printf("message       tips  battery  temperature  from     tips in each 1.9s of the window\n");
+    }
+    for(size_t i=0;i<seriesLength;i++){
+        const Reading *reading = &series[i];
+        if(i && reading->message == series[i-1].message){
+            continue; //Another copy, the best came first
+        }
+        if(i && reading->message != series[i-1].message + 1){
+            gaps += reading->message - series[i-1].message - 1;
+        }
+        direct += reading->direct;
+        rebuilt += !reading->direct;
+        noTemperature += reading->temperature == NO_TEMPERATURE;
+        if(quiet){
+            continue;
+        }
+        printf("%7u %10u %8u ", reading->message, reading->tips, reading->battery);
+        if(reading->temperature == NO_TEMPERATURE){
+            printf("%12s", "-");
+        }
+        else{
+            printf("%12u", reading->temperature);
+        }
+        printf("  %s", reading->direct ? "packet" : "carried");
+        if(reading->hasHistogram){
+            printf("   ");
+        }
+        for(unsigned i=0;i<HISTOGRAM_BUCKETS && reading->hasHistogram;i++){
+            putchar('0' + (reading->histogram >> (30 - 2 * i) & 3));
+        }
+        putchar('\n');
+    }
+    printf("packets          %u, %u dropped, %u not valid, %u passed the radio's CRC\n",
+           packets, dropped, bad, radioChecked);
+    if(flipEvery){
+        printf("corrupted        %u, %u caught\n", flipped, flippedBad);
+    }
+    printf("readings         %u, %u from their own packet, %u rebuilt from later ones, %u without temperature\n",
+           direct + rebuilt, direct, rebuilt, noTemperature);
+    printf("missing          %u message counts\n", gaps);
+    free(series);
+    return 0;
+}
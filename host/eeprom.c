@@ -0,0 +1,107 @@
+/*
+ * File:   eeprom.c
+ * Author: Andy Page
+ * Comments: Simulated data EEPROM, see eeprom.h
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <stdint.h>
+#include "eeprom.h"
+
+static uint8_t cells[EEPROM_SIZE];
+static uint32_t wear[EEPROM_SIZE];
+static uint32_t writes;
+static uint32_t reads;
+static uint8_t writing;
+static uint16_t writeAddress;
+static uint8_t writeData;
+static uint64_t writeEnd;
+static uint32_t failCountdown;
+static void (*failHandler)(void);
+
+void eepromErase(void){
+    for(unsigned i=0;i<EEPROM_SIZE;i++){
+        cells[i] = 0xFF;
+        wear[i] = 0;
+    }
+    writes = 0;
+    reads = 0;
+    writing = 0;
+    failCountdown = 0;
+}
+
+uint8_t eepromRead(uint16_t address){
+    reads++;
+    return cells[address % EEPROM_SIZE];
+}
+
+void eepromStartWrite(uint64_t now_ns, uint16_t address, uint8_t data){
+    writing = 1;
+    writeAddress = address % EEPROM_SIZE;
+    writeData = data;
+    writeEnd = now_ns + EEPROM_WRITE_NS;
+    if(failCountdown && --failCountdown == 0){
+        failHandler();
+    }
+}
+
+uint8_t eepromBusy(void){
+    return writing;
+}
+
+uint64_t eepromNextEvent(void){
+    return writing ? writeEnd : UINT64_MAX;
+}
+
+/**
+ * End of the write.  Every write is an erase and program cycle, whatever the
+ * old value was.
+ */
+void eepromEvent(uint64_t now_ns){
+    if(!writing || now_ns < writeEnd){
+        return;
+    }
+    cells[writeAddress] = writeData;
+    wear[writeAddress]++;
+    writes++;
+    writing = 0;
+}
+
+/**
+ * The supply went during a write.  The cell has been erased and only some of
+ * its bits programmed, taken as the top four.
+ */
+void eepromPowerFail(void){
+    if(writing){
+        cells[writeAddress] = writeData | 0x0F;
+        wear[writeAddress]++;
+        writes++;
+        writing = 0;
+    }
+}
+
+/**
+ * Arranges a power failure part way through a later write, for testing what
+ * the firmware finds in the EEPROM afterwards.  fail() is called as the write
+ * starts and would normally call eepromPowerFail() and not return.
+ */
+void eepromFailAt(uint32_t write, void (*fail)(void)){
+    failCountdown = write;
+    failHandler = fail;
+}
+
+uint32_t eepromCurrent_uA(void){
+    return writing ? EEPROM_I_WRITE_UA : 0;
+}
+
+uint32_t eepromWear(uint16_t address){
+    return wear[address % EEPROM_SIZE];
+}
+
+uint32_t eepromWrites(void){
+    return writes;
+}
+
+uint32_t eepromReads(void){
+    return reads;
+}
@@ -0,0 +1,36 @@
+/*
+ * File:   eeprom.h
+ * Author: Andy Page
+ * Comments: Simulated PIC18F46K22 data EEPROM (1KB).  Keeps the contents and
+ * a count of writes for every cell, so the wear the firmware causes can be
+ * measured.  A write takes EEPROM_WRITE_NS and only changes the cell when it
+ * finishes.
+ * Revision history: 1, 15th October 2026
+ */
+
+#ifndef HOST_EEPROM_H
+#define	HOST_EEPROM_H
+
+#include <stdint.h>
+
+#define EEPROM_SIZE 1024
+#define EEPROM_WRITE_NS 4000000ULL //TDEW, typical
+#define EEPROM_I_WRITE_UA 3000 //Estimated, not measured
+#define EEPROM_ENDURANCE 100000UL //Erase/write cycles per byte, data sheet minimum
+
+void eepromErase(void); //Blank (0xFF) with no wear, as from the factory
+uint8_t eepromRead(uint16_t address);
+void eepromStartWrite(uint64_t now_ns, uint16_t address, uint8_t data);
+uint8_t eepromBusy(void);
+uint64_t eepromNextEvent(void); //End of the write in progress, UINT64_MAX if none
+void eepromEvent(uint64_t now_ns);
+void eepromPowerFail(void); //Leaves the cell being written half programmed
+void eepromFailAt(uint32_t write, void (*fail)(void)); //Calls fail() once that many more writes have started, 0 for never
+uint32_t eepromCurrent_uA(void);
+
+//Inspection for the benchmarks, none of these cost simulated time
+uint32_t eepromWear(uint16_t address); //Writes to one cell
+uint32_t eepromWrites(void); //Writes to every cell
+uint32_t eepromReads(void);
+
+#endif	/* HOST_EEPROM_H */
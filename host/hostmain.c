@@ -0,0 +1,264 @@
+/*
+ * File:   hostmain.c
+ * Author: Andy Page
+ * Comments: Runs the rain gauge firmware on a PC against the simulated
+ * registers and radio, then reports what each wakeup cost.
+ *
+ * Usage: raingauge-sim [-n wakes] [-t tip interval s] [-s first tip s]
+ *                      [-k bounces] [-b battery mV] [-r wake] [-x lost wakes] [-l] [-p] [-e] [-v]
+ *   -k  follow each tip with this many reed switch bounces, 2ms apart
+ *   -r  power cycle the radio (but not the PIC) before this wakeup
+ *   -x  the radio never signals TxDone in the first this many wakeups
+ *   -l  print one line per wakeup
+ *   -p  print each packet the simulated radio sent, and its payload CRC if
+ *       the radio added one
+ *   -e  print the firmware's event log (LOG_EVENT) at the end
+ *   -v  echo the firmware's USART2 output
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "hostsim.h"
+#include "radio.h"
+#include "eeprom.h"
+#include "LoRa.h" //Modem settings and time on air macros
+#include "log.h"
+
+void firmwareMain(void); //main() in main.c, renamed by the host Makefile
+extern volatile uint32_t tips; //Tip counter in main.c
+
+static const char *reasonNames[] = {"POR", "WDT", "INT1", "INT2"};
+
+static unsigned reasons[4];
+static double awakeSum_ms;
+static double awakeMax_ms;
+static double spiTransactionSum;
+static double spiByteSum;
+static double spiSelectSum_ms;
+static double uartByteSum;
+static double chargeSum_uC;
+static double packetChargeSum_uC; //Wakeups that sent a packet
+static double sleepSum_ms; //Asleep inside a wakeup waiting for the radio
+static unsigned packetSum;
+static uint64_t *txStarts; //Start of every packet, for the duty cycle
+static unsigned txCount;
+static unsigned txSize;
+static uint64_t worstHour_ns; //Most time on air in any hour
+static int listWakes;
+static int listPackets;
+static int listEvents;
+
+/**
+ * Adds a packet and updates the most time on air in the hour ending with it.
+ * Packets are all the same length, so the hour's total is count * airtime.
+ */
+static void dutyCycle(uint64_t start_ns, uint64_t airtime_ns){
+    if(txCount == txSize){
+        txSize = txSize ? txSize * 2 : 64;
+        txStarts = realloc(txStarts, txSize * sizeof(*txStarts));
+        if(!txStarts){
+            abort();
+        }
+    }
+    txStarts[txCount++] = start_ns;
+    unsigned first = txCount - 1;
+    while(first > 0 && start_ns - txStarts[first - 1] < 3600000000000ULL){
+        first--;
+    }
+    uint64_t hour_ns = (uint64_t)(txCount - first) * airtime_ns;
+    if(hour_ns > worstHour_ns){
+        worstHour_ns = hour_ns;
+    }
+}
+
+static void onWake(const HostWake *wake){
+    double awake_ms = wake->awake_ns / 1e6;
+    reasons[wake->reason]++;
+    awakeSum_ms += awake_ms;
+    if(awake_ms > awakeMax_ms){
+        awakeMax_ms = awake_ms;
+    }
+    spiTransactionSum += wake->spiTransactions;
+    spiByteSum += wake->spiBytes;
+    spiSelectSum_ms += wake->spiSelect_ns / 1e6;
+    uartByteSum += wake->uartBytes;
+    chargeSum_uC += wake->charge_uC;
+    packetSum += wake->packets;
+    if(wake->packets){
+        packetChargeSum_uC += wake->charge_uC;
+        dutyCycle(radioLastTxStart_ns(), radioLastAirtime_ns());
+    }
+    sleepSum_ms += wake->sleep_ns / 1e6;
+    if(listWakes){
+        printf("%12.3f s %-4s awake %8.3f ms  sleep %8.3f ms  spi %4u/%5u B %7.3f ms  uart %4u B  tx %u  %9.1f uJ\n",
+               wake->start_ns / 1e9, reasonNames[wake->reason], awake_ms, wake->sleep_ns / 1e6,
+               wake->spiTransactions, wake->spiBytes, wake->spiSelect_ns / 1e6,
+               wake->uartBytes, wake->packets, wake->charge_uC * HOST_VDD_V);
+    }
+    if(listPackets && wake->packets){
+        uint8_t packet[256];
+        uint8_t length = radioLastPacket(packet);
+        printf("  packet %3u B %7.3f ms on air:", length, radioLastAirtime_ns() / 1e6);
+        for(uint8_t i=0;i<length;i++){
+            printf(" %02X", packet[i]);
+        }
+        uint16_t crc;
+        if(radioLastPayloadCRC(&crc)){
+            printf(" crc %04X", crc); //Added by the radio, see loracrc.h
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * Reads the event ring buffer straight out of the firmware's RAM, as the
+ * debugger would, so it costs no simulated UART time.
+ */
+static void printEvents(void){
+#if LOG_EVENTS > 0
+    static const char *names[] = {
+        [EV_WAKE] = "wake", [EV_UVLO] = "uvlo", [EV_SPURIOUS_WAKE] = "spurious",
+        [EV_RECOVERED] = "recovered", [EV_CHECKPOINT] = "checkpoint",
+        [EV_QUEUED] = "queued", [EV_FORWARDED] = "forwarded", [EV_AGED_OUT] = "aged out",
+        [EV_LORA_COLD] = "lora cold", [EV_LORA_WARM] = "lora warm",
+        [EV_TX_START] = "tx start", [EV_TX_DONE] = "tx done", [EV_TX_TIMEOUT] = "tx timeout"
+    };
+    unsigned count = logNext < LOG_EVENTS ? logNext : LOG_EVENTS; //Short runs only
+    for(uint8_t sequence = logNext - count; sequence != logNext; sequence++){
+        const LogEvent *entry = &logEvents[sequence % LOG_EVENTS];
+        const char *name = entry->event < sizeof(names) / sizeof(*names) ? names[entry->event] : 0;
+        printf("  event %3u %-10s %5u\n", sequence, name ? name : "?", entry->value);
+    }
+#else
+    printf("  event log not built (LOG_EVENTS 0)\n");
+#endif
+}
+
+int main(int argc, char **argv){
+    double tipInterval_s = 0;
+    double firstTip_s = 0;
+    unsigned bounces = 0;
+    int option;
+
+    hostConfig.onWake = onWake;
+    while((option = getopt(argc, argv, "n:t:s:k:b:r:x:lpev")) != -1){
+        switch(option){
+            case 'n':
+                hostConfig.maxWakes = (unsigned)atoi(optarg);
+                break;
+            case 't':
+                tipInterval_s = atof(optarg);
+                break;
+            case 's':
+                firstTip_s = atof(optarg);
+                break;
+            case 'k':
+                bounces = (unsigned)atoi(optarg);
+                break;
+            case 'b':
+                hostConfig.battery_mV = (uint16_t)atoi(optarg);
+                break;
+            case 'r':
+                hostConfig.radioPowerCycleWake = (unsigned)atoi(optarg);
+                break;
+            case 'x':
+                hostConfig.txLostWakes = (unsigned)atoi(optarg);
+                break;
+            case 'l':
+                listWakes = 1;
+                break;
+            case 'p':
+                listPackets = 1;
+                break;
+            case 'e':
+                listEvents = 1;
+                break;
+            case 'v':
+                hostConfig.echoUart = 1;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n wakes] [-t tip interval s] [-s first tip s] [-k bounces] [-b battery mV] [-r wake] [-x lost wakes] [-l] [-p] [-e] [-v]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(hostConfig.maxWakes == 0){
+        hostConfig.maxWakes = 1;
+    }
+
+    hostReset();
+    if(tipInterval_s > 0){
+        //Enough tips to cover every wakeup even if they all came from the watchdog
+        double end_s = (double)hostConfig.maxWakes * HOST_WDT_NS / 1e9;
+        for(double t = firstTip_s > 0 ? firstTip_s : tipInterval_s; t < end_s; t += tipInterval_s){
+            hostScheduleTip((uint64_t)(t * 1e9));
+            for(unsigned i=1;i<=bounces;i++){
+                hostScheduleTip((uint64_t)(t * 1e9) + i * 2000000ULL);
+            }
+        }
+    }
+    unsigned wakes = hostRun(firmwareMain);
+
+    double elapsed_s = hostNow() / 1e9;
+    if(listEvents){
+        printEvents();
+    }
+    printf("wakeups          %u (POR %u, WDT %u, INT1 %u)\n", wakes,
+           reasons[WAKE_POR], reasons[WAKE_WDT], reasons[WAKE_INT1]);
+    printf("simulated time   %.3f s\n", elapsed_s);
+    if(hostTipEdges()){
+        printf("rain tips        %u, %lu counted by the firmware", (hostTipEdges() + bounces) / (bounces + 1), (unsigned long)tips);
+        if(bounces){
+            printf(" (%u edges on INT1)", hostTipEdges());
+        }
+        printf("\n");
+    }
+    printf("packets sent     %u", packetSum);
+    if(packetSum){
+        uint8_t packet[256];
+        uint8_t length = radioLastPacket(packet);
+        uint32_t macro_us = LORA_TIME_ON_AIR_US(length);
+        printf(", %.3f ms on air at %d dBm", radioLastAirtime_ns() / 1e6, radioTxPower_dBm());
+        if(macro_us != radioLastAirtime_ns() / 1000){
+            printf(" (LORA_TIME_ON_AIR_US says %.3f ms)", macro_us / 1e3);
+        }
+        printf("\nduty cycle       worst hour %.3f s on air, %.3f s allowed at 1%% (%lu packets)",
+               worstHour_ns / 1e9, LORA_BUDGET_US_PER_HOUR(10) / 1e6,
+               LORA_PACKETS_PER_HOUR(macro_us, 10));
+    }
+    printf("\n");
+    uint32_t frf = (uint32_t)radioRegister(FRF_MSB_REG) << 16 | (uint32_t)radioRegister(FRF_MID_REG) << 8 | radioRegister(FRF_LSB_REG);
+    printf("frequency        %.6f MHz (FRF 0x%06X)\n", LORA_FRF_HZ(frf) / 1e6, (unsigned)frf);
+    if(radioFifoErrors()){
+        printf("FIFO errors      %u (FIFO used in sleep or before the oscillator started)\n", radioFifoErrors());
+    }
+    printf("awake per wake   %.3f ms mean, %.3f ms max", awakeSum_ms / wakes, awakeMax_ms);
+    if(sleepSum_ms > 0){
+        printf(", plus %.3f ms asleep or idle (radio, tip window)", sleepSum_ms / wakes);
+    }
+    printf("\n");
+    printf("SPI per wake     %.1f transactions, %.1f bytes, %.3f ms SS low\n",
+           spiTransactionSum / wakes, spiByteSum / wakes, spiSelectSum_ms / wakes);
+    printf("UART per wake    %.1f bytes\n", uartByteSum / wakes);
+    if(hostUARTLost()){
+        printf("UART errors      %u bytes overwritten or cut off by SLEEP\n", hostUARTLost());
+    }
+    if(eepromWrites()){
+        uint32_t worst = 0;
+        for(uint16_t i=0;i<EEPROM_SIZE;i++){
+            if(eepromWear(i) > worst){
+                worst = eepromWear(i);
+            }
+        }
+        printf("EEPROM           %u bytes written, most writes to one byte %u\n", eepromWrites(), worst);
+    }
+    printf("energy per wake  %.1f uJ\n", chargeSum_uC * HOST_VDD_V / wakes);
+    if(packetSum){
+        printf("energy per packet %.1f uJ (whole wakeup, radio included)\n", packetChargeSum_uC * HOST_VDD_V / packetSum);
+    }
+    if(elapsed_s > 0){
+        printf("average current  %.2f uA\n", hostTotalCharge_uC() / elapsed_s);
+    }
+    return 0;
+}
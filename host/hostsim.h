@@ -0,0 +1,112 @@
+/*
+ * File:   hostsim.h
+ * Author: Andy Page
+ * Comments: Host simulator for the LoRa rain gauge firmware.
+ * Keeps a simulated clock, charges every wait (delays, SPI/UART byte times,
+ * A to D conversions, sleep) against a simple current model and records what
+ * each wakeup cost.  The firmware reaches it through host/include/xc.h and the
+ * HOST_BUILD half of hal.h.
+ * Revision history: 1, 15th October 2026
+ */
+
+#ifndef HOST_HOSTSIM_H
+#define	HOST_HOSTSIM_H
+
+#include <stdint.h>
+
+#define HOST_FOSC_HZ 64000000UL
+#define HOST_TCY_NS 62 //One instruction cycle (Fosc/4), rounded down
+#define HOST_WDT_NS 131072000000ULL //4ms * WDTPS 32768
+#define HOST_WAKE_START_NS 2064000ULL //Oscillator start-up (1024 Tosc) plus PLL lock (2ms)
+#define HOST_LFINTOSC_HZ 31000UL
+#define HOST_IDLE_WAKE_CYCLES 50 //Instruction cycles for each wake from idle (interrupt entry, Isr(), back to SLEEP)
+
+//Supply current model in microamps at 3V
+#define HOST_VDD_V 3.0
+#define HOST_I_MCU_RUN_UA 11500 //PIC18F46K22 running at 64MHz (HS + PLL)
+#define HOST_I_MCU_SLEEP_UA 12 //Whole board asleep (see README)
+//On LFINTOSC, whole board.  Estimated from the data sheet typicals, not measured
+#define HOST_I_MCU_LF_RUN_UA 30
+#define HOST_I_MCU_LF_IDLE_UA 20
+#define HOST_I_PRIMARY_UA 3000 //Crystal and PLL left running while on LFINTOSC (PRISD set), estimated
+#define HOST_I_LED_UA 2000 //Per LED
+#define HOST_I_EXT_UA 250 //Battery and NTC dividers while RA2 is low
+
+typedef enum {
+    WAKE_POR,
+    WAKE_WDT,
+    WAKE_INT1,
+    WAKE_INT2 //Radio DIO0, does not start a new wakeup
+} HostWakeReason;
+
+/**
+ * What one pass through the firmware cost, from wakeup to the next SLEEP().
+ */
+typedef struct {
+    HostWakeReason reason;
+    uint64_t start_ns; //Simulated time the PIC woke up
+    uint64_t awake_ns; //Time from wakeup to SLEEP(), less sleep_ns
+    uint64_t sleep_ns; //Time asleep (radio INT2) or idle (Timer1 ticks) inside the wakeup
+    uint32_t spiTransactions; //Number of times SS was taken low
+    uint32_t spiBytes;
+    uint64_t spiSelect_ns; //Time SS was held low
+    uint32_t uartBytes;
+    uint32_t packets; //Transmissions started by the radio
+    double charge_uC; //Charge drawn from wakeup to the SLEEP() that ends it
+} HostWake;
+
+typedef struct {
+    unsigned maxWakes; //Stop after this many wakeups
+    uint16_t battery_mV;
+    double ntcRatio; //NTC divider output as a fraction of Vdd
+    int echoUart; //Copy USART2 output to stdout
+    unsigned radioPowerCycleWake; //Power cycle the radio alone before this wakeup, 0 for never
+    unsigned txLostWakes; //Transmissions in the first this many wakeups never signal TxDone
+    void (*onWake)(const HostWake *); //Called at the end of every wakeup
+} HostConfig;
+
+extern HostConfig hostConfig;
+
+/**
+ * Harness interface
+ */
+void hostReset(void);
+void hostScheduleTip(uint64_t at_ns);
+unsigned hostRun(void (*entry)(void));
+uint64_t hostNow(void);
+double hostTotalCharge_uC(void);
+uint32_t hostUARTLost(void); //USART2 bytes overwritten or cut off by SLEEP
+uint32_t hostTipEdges(void); //INT1 edges delivered so far
+uint8_t hostTxLost(void); //The radio should not finish the transmission being started
+
+/**
+ * Firmware interface (used through xc.h and hal.h)
+ */
+void hostDelayNs(uint64_t ns);
+void hostSleep(void);
+void hostClockInternal(void);
+void hostClockPrimary(void);
+void hostInterruptsOn(void);
+void hostClearWDT(void);
+void hostSPI2Select(void);
+uint8_t hostSPI2Transfer(uint8_t data);
+void hostSPI2Deselect(void);
+void hostADCStart(void);
+void hostADCWait(void);
+void hostEepromRead(void);
+void hostEepromWrite(void);
+void hostEepromWait(void);
+uint8_t hostUART2TxIdle(void);
+uint8_t hostUART2TxReady(void);
+void hostUART2Write(uint8_t data);
+int hostPrintf(const char *format, ...);
+
+void hostSFRReset(void); //Power on reset values (sfr.c)
+
+/**
+ * Firmware functions the simulator calls
+ */
+void Isr(void);
+void putch(char);
+
+#endif	/* HOST_HOSTSIM_H */
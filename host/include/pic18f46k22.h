@@ -0,0 +1,8 @@
+/*
+ * File:   pic18f46k22.h (host build)
+ * Author: Andy Page
+ * Comments: The host <xc.h> already declares every register the firmware uses.
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <xc.h>
@@ -0,0 +1,302 @@
+/*
+ * File:   xc.h (host build)
+ * Author: Andy Page
+ * Comments: Stand-in for the XC8 <xc.h> when the firmware is compiled for a PC.
+ * Declares the PIC18F46K22 special function registers the firmware touches as
+ * plain variables (defined in sfr.c) and maps the XC8 built-ins (__delay_ms,
+ * SLEEP, __interrupt, printf/putch) onto the simulator in sim.c.
+ * Only the registers and bits used by the firmware are declared - add more
+ * here when the firmware starts using them.
+ * Revision history: 1, 15th October 2026
+ */
+
+#ifndef HOST_XC_H
+#define	HOST_XC_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "hostsim.h"
+
+//XC8 provides printf through putch() and declares its own putchar().
+//Route both through the firmware USART2 code so output costs awake time.
+#define printf hostPrintf
+#define putchar firmwarePutchar
+
+//XC8 built-ins
+#define __interrupt(...)
+#define __delay_us(x) hostDelayNs((uint64_t)(x)*1000ULL)
+#define __delay_ms(x) hostDelayNs((uint64_t)(x)*1000000ULL)
+#define SLEEP() hostSleep()
+#define CLRWDT() hostClearWDT()
+#define NOP() hostDelayNs(HOST_TCY_NS)
+
+/**
+ * Port registers
+ */
+#define HOST_PORT_REGS(X) \
+typedef union { \
+    struct { uint8_t R##X##0:1, R##X##1:1, R##X##2:1, R##X##3:1, R##X##4:1, R##X##5:1, R##X##6:1, R##X##7:1; }; \
+    struct { uint8_t TRIS##X##0:1, TRIS##X##1:1, TRIS##X##2:1, TRIS##X##3:1, TRIS##X##4:1, TRIS##X##5:1, TRIS##X##6:1, TRIS##X##7:1; }; \
+    uint8_t reg; \
+} TRIS##X##bits_t; \
+typedef union { \
+    struct { uint8_t LAT##X##0:1, LAT##X##1:1, LAT##X##2:1, LAT##X##3:1, LAT##X##4:1, LAT##X##5:1, LAT##X##6:1, LAT##X##7:1; }; \
+    struct { uint8_t L##X##0:1, L##X##1:1, L##X##2:1, L##X##3:1, L##X##4:1, L##X##5:1, L##X##6:1, L##X##7:1; }; \
+    uint8_t reg; \
+} LAT##X##bits_t; \
+typedef union { \
+    struct { uint8_t ANS##X##0:1, ANS##X##1:1, ANS##X##2:1, ANS##X##3:1, ANS##X##4:1, ANS##X##5:1, ANS##X##6:1, ANS##X##7:1; }; \
+    uint8_t reg; \
+} ANSEL##X##bits_t; \
+extern volatile TRIS##X##bits_t TRIS##X##bits; \
+extern volatile LAT##X##bits_t LAT##X##bits; \
+extern volatile ANSEL##X##bits_t ANSEL##X##bits;
+
+HOST_PORT_REGS(A)
+HOST_PORT_REGS(B)
+HOST_PORT_REGS(C)
+HOST_PORT_REGS(D)
+HOST_PORT_REGS(E)
+
+#define TRISA TRISAbits.reg
+#define TRISB TRISBbits.reg
+#define TRISC TRISCbits.reg
+#define TRISD TRISDbits.reg
+#define TRISE TRISEbits.reg
+#define LATA LATAbits.reg
+#define LATB LATBbits.reg
+#define LATC LATCbits.reg
+#define LATD LATDbits.reg
+#define LATE LATEbits.reg
+#define ANSELA ANSELAbits.reg
+#define ANSELB ANSELBbits.reg
+#define ANSELC ANSELCbits.reg
+#define ANSELD ANSELDbits.reg
+#define ANSELE ANSELEbits.reg
+
+/**
+ * Peripheral module disable
+ */
+typedef union {
+    struct { uint8_t TMR1MD:1, TMR2MD:1, TMR3MD:1, TMR4MD:1, TMR5MD:1, TMR6MD:1, UART1MD:1, UART2MD:1; };
+    struct { uint8_t :6, SPI1MD:1, SPI2MD:1; }; //XC8 aliases used by the firmware
+    uint8_t reg;
+} PMD0bits_t;
+typedef union {
+    struct { uint8_t CCP1MD:1, CCP2MD:1, CCP3MD:1, CCP4MD:1, CCP5MD:1, :1, MSSP1MD:1, MSSP2MD:1; };
+    uint8_t reg;
+} PMD1bits_t;
+typedef union {
+    struct { uint8_t ADCMD:1, CMP1MD:1, CMP2MD:1, CTMUMD:1, :4; };
+    uint8_t reg;
+} PMD2bits_t;
+extern volatile PMD0bits_t PMD0bits;
+extern volatile PMD1bits_t PMD1bits;
+extern volatile PMD2bits_t PMD2bits;
+#define PMD0 PMD0bits.reg
+#define PMD1 PMD1bits.reg
+#define PMD2 PMD2bits.reg
+
+/**
+ * Interrupt control
+ */
+typedef union {
+    struct { uint8_t RBIF:1, INT0IF:1, TMR0IF:1, RBIE:1, INT0IE:1, TMR0IE:1, PEIE:1, GIE:1; };
+    struct { uint8_t :1, INT0F:1, :2, INT0E:1, :1, PEIE_GIEL:1, GIE_GIEH:1; };
+    uint8_t reg;
+} INTCONbits_t;
+typedef union {
+    struct { uint8_t RBIP:1, :1, TMR0IP:1, :1, INTEDG2:1, INTEDG1:1, INTEDG0:1, NOT_RBPU:1; };
+    uint8_t reg;
+} INTCON2bits_t;
+typedef union {
+    struct { uint8_t INT1IF:1, INT2IF:1, :1, INT1IE:1, INT2IE:1, :1, INT1IP:1, INT2IP:1; };
+    struct { uint8_t INT1F:1, INT2F:1, :1, INT1E:1, INT2E:1, :3; };
+    uint8_t reg;
+} INTCON3bits_t;
+extern volatile INTCONbits_t INTCONbits;
+extern volatile INTCON2bits_t INTCON2bits;
+extern volatile INTCON3bits_t INTCON3bits;
+#define INTCON INTCONbits.reg
+#define INTCON2 INTCON2bits.reg
+#define INTCON3 INTCON3bits.reg
+typedef union {
+    struct { uint8_t TMR1GIF:1, TMR3GIF:1, TMR5GIF:1, CTMUIF:1, TX2IF:1, RC2IF:1, BCL2IF:1, SSP2IF:1; };
+    uint8_t reg;
+} PIR3bits_t;
+typedef union {
+    struct { uint8_t TMR1GIE:1, TMR3GIE:1, TMR5GIE:1, CTMUIE:1, TX2IE:1, RC2IE:1, BCL2IE:1, SSP2IE:1; };
+    uint8_t reg;
+} PIE3bits_t;
+extern volatile PIR3bits_t PIR3bits; //Only TX2IF is kept up to date, SSP2IF is separate
+extern volatile PIE3bits_t PIE3bits;
+#define PIR3 PIR3bits.reg
+#define PIE3 PIE3bits.reg
+
+typedef union {
+    struct { uint8_t TMR1IF:1, TMR2IF:1, CCP1IF:1, SSP1IF:1, TX1IF:1, RC1IF:1, ADIF:1, :1; };
+    uint8_t reg;
+} PIR1bits_t;
+typedef union {
+    struct { uint8_t TMR1IE:1, TMR2IE:1, CCP1IE:1, SSP1IE:1, TX1IE:1, RC1IE:1, ADIE:1, :1; };
+    uint8_t reg;
+} PIE1bits_t;
+typedef union {
+    struct { uint8_t CCP2IF:1, TMR3IF:1, HLVDIF:1, BCL1IF:1, EEIF:1, C2IF:1, C1IF:1, OSCFIF:1; };
+    uint8_t reg;
+} PIR2bits_t;
+typedef union {
+    struct { uint8_t CCP2IE:1, TMR3IE:1, HLVDIE:1, BCL1IE:1, EEIE:1, C2IE:1, C1IE:1, OSCFIE:1; };
+    uint8_t reg;
+} PIE2bits_t;
+extern volatile PIR1bits_t PIR1bits; //Only TMR1IF is kept up to date
+extern volatile PIE1bits_t PIE1bits;
+extern volatile PIR2bits_t PIR2bits; //Only TMR3IF and EEIF are kept up to date
+extern volatile PIE2bits_t PIE2bits;
+#define PIR1 PIR1bits.reg
+#define PIE1 PIE1bits.reg
+#define PIR2 PIR2bits.reg
+#define PIE2 PIE2bits.reg
+
+/**
+ * Reset control
+ */
+typedef union {
+    struct { uint8_t NOT_BOR:1, NOT_POR:1, NOT_PD:1, NOT_TO:1, NOT_RI:1, :1, SBOREN:1, IPEN:1; };
+    uint8_t reg;
+} RCONbits_t;
+extern volatile RCONbits_t RCONbits;
+#define RCON RCONbits.reg
+
+/**
+ * Oscillator
+ */
+typedef union {
+    struct { uint8_t SCS:2, HFIOFS:1, OSTS:1, IRCF:3, IDLEN:1; };
+    uint8_t reg;
+} OSCCONbits_t;
+typedef union {
+    struct { uint8_t LFIOFS:1, MFIOFS:1, PRISD:1, SOSCGO:1, MFIOSEL:1, :1, SOSCRUN:1, PLLRDY:1; };
+    uint8_t reg;
+} OSCCON2bits_t;
+typedef union {
+    struct { uint8_t TUN:6, PLLEN:1, INTSRC:1; };
+    uint8_t reg;
+} OSCTUNEbits_t;
+extern volatile OSCCONbits_t OSCCONbits;
+extern volatile OSCCON2bits_t OSCCON2bits;
+extern volatile OSCTUNEbits_t OSCTUNEbits;
+#define OSCCON OSCCONbits.reg
+#define OSCCON2 OSCCON2bits.reg
+#define OSCTUNE OSCTUNEbits.reg
+
+/**
+ * Timer1 and Timer3
+ */
+typedef union {
+    struct { uint8_t TMR1ON:1, T1RD16:1, NOT_T1SYNC:1, T1SOSCEN:1, T1CKPS:2, TMR1CS:2; };
+    uint8_t reg;
+} T1CONbits_t;
+typedef union {
+    struct { uint8_t TMR3ON:1, T3RD16:1, NOT_T3SYNC:1, T3SOSCEN:1, T3CKPS:2, TMR3CS:2; };
+    uint8_t reg;
+} T3CONbits_t;
+extern volatile T1CONbits_t T1CONbits;
+extern volatile T3CONbits_t T3CONbits;
+extern volatile uint8_t TMR1H;
+extern volatile uint8_t TMR1L;
+extern volatile uint8_t TMR3H;
+extern volatile uint8_t TMR3L;
+#define T1CON T1CONbits.reg
+#define T3CON T3CONbits.reg
+
+/**
+ * Data EEPROM
+ */
+typedef union {
+    struct { uint8_t RD:1, WR:1, WREN:1, WRERR:1, FREE:1, :1, CFGS:1, EEPGD:1; };
+    uint8_t reg;
+} EECON1bits_t;
+extern volatile EECON1bits_t EECON1bits;
+extern volatile uint8_t EECON2;
+extern volatile uint8_t EEADRH;
+extern volatile uint8_t EEADR;
+extern volatile uint8_t EEDATA;
+#define EECON1 EECON1bits.reg
+
+/**
+ * A to D converter and fixed voltage reference
+ */
+typedef union {
+    struct { uint8_t ADON:1, GO_NOT_DONE:1, CHS:5, :1; };
+    struct { uint8_t :1, GO:1, :6; };
+    uint8_t reg;
+} ADCON0bits_t;
+typedef union {
+    struct { uint8_t NVCFG:2, PVCFG:2, :3, TRIGSEL:1; };
+    uint8_t reg;
+} ADCON1bits_t;
+typedef union {
+    struct { uint8_t ADCS:3, ACQT:3, :1, ADFM:1; };
+    uint8_t reg;
+} ADCON2bits_t;
+typedef union {
+    struct { uint8_t :4, FVRS:2, FVRST:1, FVREN:1; };
+    uint8_t reg;
+} VREFCON0bits_t;
+extern volatile ADCON0bits_t ADCON0bits;
+extern volatile ADCON1bits_t ADCON1bits;
+extern volatile ADCON2bits_t ADCON2bits;
+extern volatile VREFCON0bits_t VREFCON0bits;
+extern volatile uint8_t ADRESH;
+extern volatile uint8_t ADRESL;
+#define ADCON0 ADCON0bits.reg
+#define ADCON1 ADCON1bits.reg
+#define ADCON2 ADCON2bits.reg
+#define VREFCON0 VREFCON0bits.reg
+
+/**
+ * MSSP2 (SPI2)
+ */
+typedef union {
+    struct { uint8_t SSPM:4, CKP:1, SSPEN:1, SSPOV:1, WCOL:1; };
+    uint8_t reg;
+} SSP2CON1bits_t;
+typedef union {
+    struct { uint8_t BF:1, UA:1, R_NOT_W:1, S:1, P:1, D_NOT_A:1, CKE:1, SMP:1; };
+    uint8_t reg;
+} SSP2STATbits_t;
+extern volatile SSP2CON1bits_t SSP2CON1bits;
+extern volatile SSP2STATbits_t SSP2STATbits;
+extern volatile uint8_t SSP2BUF;
+extern volatile uint8_t SSP2IF;
+#define SSP2CON1 SSP2CON1bits.reg
+#define SSP2STAT SSP2STATbits.reg
+
+/**
+ * EUSART2
+ */
+typedef union {
+    struct { uint8_t TX9D:1, TRMT:1, BRGH:1, SENDB:1, SYNC:1, TXEN:1, TX9:1, CSRC:1; };
+    uint8_t reg;
+} TXSTA2bits_t;
+typedef union {
+    struct { uint8_t RX9D:1, OERR:1, FERR:1, ADDEN:1, CREN:1, SREN:1, RX9:1, SPEN:1; };
+    uint8_t reg;
+} RCSTA2bits_t;
+typedef union {
+    struct { uint8_t ABDEN:1, WUE:1, :1, BRG16:1, CKTXP:1, DTRXP:1, RCIDL:1, ABDOVF:1; };
+    uint8_t reg;
+} BAUDCON2bits_t;
+extern volatile TXSTA2bits_t TXSTA2bits;
+extern volatile RCSTA2bits_t RCSTA2bits;
+extern volatile BAUDCON2bits_t BAUDCON2bits;
+extern volatile uint8_t SPBRGH2;
+extern volatile uint8_t SPBRG2;
+extern volatile uint8_t TXREG2;
+#define TXSTA2 TXSTA2bits.reg
+#define RCSTA2 RCSTA2bits.reg
+#define BAUDCON2 BAUDCON2bits.reg
+#define TRMT2 TXSTA2bits.TRMT
+
+#endif	/* HOST_XC_H */
@@ -0,0 +1,32 @@
+/*
+ * File:   loracrc.h
+ * Author: Andy Page
+ * Comments: The payload CRC an SX1276 adds on air when RxPayloadCrcOn is set
+ * in RegModemConfig2, for the simulated radio and the gateway side decoder.
+ * It is a CRC-16/CCITT (polynomial 0x1021, starting at 0, MSB first) over
+ * all but the last two payload bytes, which are then XORed in, as the chip
+ * has been found to do.  The receiving radio checks it and flags
+ * PayloadCrcError, so a gateway only ever sees the payload.
+ * Revision history: 1, 15th October 2026
+ */
+
+#ifndef HOST_LORACRC_H
+#define	HOST_LORACRC_H
+
+#include <stdint.h>
+
+static inline uint16_t loraPayloadCRC(const uint8_t *payload, unsigned length){
+    uint16_t crc = 0;
+    for(unsigned i=0;i+2<length;i++){
+        crc ^= (uint16_t)(payload[i] << 8);
+        for(int bit=0;bit<8;bit++){
+            crc = (uint16_t)(crc & 0x8000 ? crc << 1 ^ 0x1021 : crc << 1);
+        }
+    }
+    if(length >= 2){
+        crc ^= (uint16_t)(payload[length-2] << 8 | payload[length-1]);
+    }
+    return crc;
+}
+
+#endif	/* HOST_LORACRC_H */
@@ -0,0 +1,111 @@
+/*
+ * File:   packet.hpp
+ * Author: Andy Page
+ * Comments: Gateway side view of the common packet format, built from the
+ * field lists in the firmware's packet.h so it cannot drift from what
+ * transmitData() sends.  A View reads the fields in place, without copying
+ * the packet: get<Data::TIPS>() gives the number, byte order and all, and
+ * get<Data::ADDRESS>() a span over the bytes.  Each field's place and size
+ * are template arguments, so a read is a handful of loads and shifts, and
+ * asking a View for a field of the other format does not compile.
+ *
+ *   packet::View<packet::Data> view(bytes);
+ *   if(view.valid(length, false)) tips = view.get<packet::Data::TIPS>();
+ *
+ * Revision history: 1, 15th October 2026
+ */
+
+#ifndef INC_PACKET_HPP
+#define INC_PACKET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "packet.h"
+#include "crc16.hpp"
+
+namespace packet {
+
+template<class Format, std::size_t At, std::size_t Size, int Order>
+struct Field {
+    using format = Format;
+    static constexpr std::size_t at = At;
+    static constexpr std::size_t size = Size;
+    static constexpr int order = Order;
+    static_assert(Order == PACKET_BYTES || Size <= 4, "number fields are at most 32 bits");
+};
+
+#define PACKET_FIELD_TYPE(format, name, at, size, order) using name = Field<format, at, size, order>;
+
+//The full packet
+struct Data {
+    static constexpr std::size_t length = DATA_PACKET_LENGTH;
+    DATA_PACKET_FIELDS(PACKET_FIELD_TYPE, Data)
+};
+
+//Sent below BATT_UVLO, without the temperature
+struct LowBattery {
+    static constexpr std::size_t length = LOW_BATTERY_PACKET_LENGTH;
+    LOW_BATTERY_PACKET_FIELDS(PACKET_FIELD_TYPE, LowBattery)
+};
+
+#undef PACKET_FIELD_TYPE
+
+static_assert(Data::CRC::at + Data::CRC::size == Data::length, "CRC16 ends the packet");
+static_assert(LowBattery::CRC::at + LowBattery::CRC::size == LowBattery::length, "CRC16 ends the packet");
+
+template<class Format>
+class View {
+public:
+    explicit constexpr View(const std::uint8_t *data) : data(data) {}
+
+    /**
+     * A number field, or a span over a PACKET_BYTES field.
+     */
+    template<class F>
+    constexpr auto get() const {
+        static_assert(std::is_same_v<typename F::format, Format>, "field of another packet format");
+        if constexpr (F::order == PACKET_BYTES) {
+            return std::span<const std::uint8_t, F::size>(data + F::at, F::size);
+        }
+        else {
+            return number<F>(std::make_index_sequence<F::size>());
+        }
+    }
+
+    /**
+     * Whether length and the length byte match this format and the packet
+     * checks out.  A gauge built without PACKET_CRC_SOFTWARE leaves the CRC16
+     * off, and then the radio's payload CRC must have been checked instead.
+     * The other fields are only worth reading if it is valid.
+     * @param radioChecked  The radio's payload CRC came with it and was right
+     */
+    bool valid(std::size_t length, bool radioChecked) const {
+        if(length < 1 || get<typename Format::LENGTH>() != length){
+            return false;
+        }
+        if(length == Format::length){
+            return get<typename Format::CRC>() == crc16::compute(data, Format::CRC::at);
+        }
+        return length == Format::CRC::at && radioChecked;
+    }
+
+private:
+    template<class F, std::size_t... I>
+    constexpr std::uint32_t number(std::index_sequence<I...>) const {
+        if constexpr (F::order == PACKET_MSB_FIRST) {
+            return ((std::uint32_t(data[F::at + I]) << (8 * (F::size - 1 - I))) | ...);
+        }
+        else {
+            return ((std::uint32_t(data[F::at + I]) << (8 * I)) | ...);
+        }
+    }
+
+    const std::uint8_t *data;
+};
+
+} // namespace packet
+
+#endif /* INC_PACKET_HPP */
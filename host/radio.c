@@ -0,0 +1,374 @@
+/*
+ * File:   radio.c
+ * Author: Andy Page
+ * Comments: Behavioural model of the RFM95W (SX1276) on the far end of SPI2.
+ * Models the register file with its LoRa mode reset values, the FIFO and
+ * FifoAddrPtr, the operating mode state machine in RegOpMode (LongRangeMode
+ * can only change in sleep, the FIFO is not accessible in sleep and is lost
+ * on entering it) and TxDone, which is raised after the real time on air for
+ * the SF/BW/CR/preamble/header settings in force when TX mode was entered.
+ * The module then drops back to standby by itself, as the real one does.
+ * Supply currents are typical figures from the SX1276 and RFM95W data sheets.
+ * Revision history: 1, 15th October 2026
+ *                   2, 15th October 2026 Behavioural model, was a register file
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "radio.h"
+#include "loracrc.h"
+#include "hostsim.h"
+#include "LoRa.h"
+
+#define IRQ_TX_DONE 0x08
+#define TX_STARTUP_NS 60000ULL //PLL lock before the PA ramps (TS_TR)
+#define OSC_STARTUP_NS 250000ULL //Crystal oscillator start when leaving sleep (TS_OSC)
+
+static uint8_t regs[0x80];
+static uint8_t fifo[256];
+static uint8_t address; //Register addressed by the current SPI transaction
+static uint8_t write; //Current SPI transaction is a write
+static uint8_t addressed; //First byte of the transaction has been received
+static uint32_t packets;
+static uint64_t txDoneAt; //UINT64_MAX when not transmitting
+static uint64_t oscReadyAt; //FIFO can be used from this time
+static uint32_t fifoErrors; //FIFO accesses made in sleep or before the oscillator started
+static uint8_t lastPacket[256];
+static uint8_t lastPacketLength;
+static uint8_t lastPayloadCRC; //RxPayloadCrcOn was set when it went
+static uint64_t lastAirtime_ns;
+static uint64_t lastTxStart_ns;
+static uint32_t writeCount[0x80]; //SPI writes to each register, for the benchmarks
+
+/**
+ * Register values after power on once LoRa mode has been selected
+ * (SX1276 data sheet table 41).
+ */
+static void loadResetValues(void){
+    memset(regs, 0, sizeof(regs));
+    regs[OP_MODE_REG] = 0x09; //FSK, low frequency mode, standby
+    regs[FRF_MSB_REG] = 0x6C; //434MHz
+    regs[FRF_MID_REG] = 0x80;
+    regs[FRF_LSB_REG] = 0x00;
+    regs[PA_CONFIG_REG] = 0x4F;
+    regs[PA_RAMP_REG] = 0x09;
+    regs[OCP_REG] = 0x2B;
+    regs[LNA_REG] = 0x20;
+    regs[FIFO_TX_BASE_ADDR_REG] = 0x80;
+    regs[MODEM_CONFIG_1_REG] = 0x72;
+    regs[MODEM_CONFIG_2_REG] = 0x70;
+    regs[SYMB_TIMEOUT_LSB_REG] = 0x64;
+    regs[PREAMBLE_LSB_REG] = 0x08;
+    regs[PAYLOAD_LENGTH_REG] = 0x01;
+    regs[MAX_PAYLOAD_LENGTH_REG] = 0xFF;
+    regs[MODEM_CONFIG_3_REG] = 0x04;
+    regs[SYNC_VALUE_REG] = 0x12;
+    regs[VERSION_REG] = 0x12;
+    regs[TXCO_REG] = 0x09;
+    regs[PA_DAC_REG] = 0x84;
+}
+
+void radioReset(void){
+    radioPowerCycle();
+    memset(writeCount, 0, sizeof(writeCount));
+    packets = 0;
+    fifoErrors = 0;
+    lastPacketLength = 0;
+    lastPayloadCRC = 0;
+    lastAirtime_ns = 0;
+    lastTxStart_ns = 0;
+}
+
+/**
+ * Power on reset of the module alone.  The benchmark counters are kept.
+ */
+void radioPowerCycle(void){
+    loadResetValues();
+    memset(fifo, 0, sizeof(fifo));
+    addressed = 0;
+    txDoneAt = UINT64_MAX;
+    oscReadyAt = hostNow() + OSC_STARTUP_NS;
+}
+
+static uint8_t mode(void){
+    return regs[OP_MODE_REG] & 0x07;
+}
+
+/**
+ * Bandwidth in Hz from RegModemConfig1 bits 7-4.
+ */
+static uint32_t bandwidthHz(uint8_t bw){
+    static const uint32_t table[] = {7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000};
+    return bw < sizeof(table)/sizeof(table[0]) ? table[bw] : 500000;
+}
+
+/**
+ * Time on air from the modem registers (SX1276 data sheet section 4.1.1.7).
+ */
+uint64_t radioTimeOnAir_ns(uint8_t payloadLength){
+    uint32_t bw = bandwidthHz(regs[MODEM_CONFIG_1_REG] >> 4);
+    int32_t cr = (regs[MODEM_CONFIG_1_REG] >> 1) & 0x07; //1 = 4/5 ... 4 = 4/8
+    int32_t implicitHeader = regs[MODEM_CONFIG_1_REG] & 0x01;
+    int32_t sf = regs[MODEM_CONFIG_2_REG] >> 4;
+    int32_t crc = (regs[MODEM_CONFIG_2_REG] >> 2) & 0x01;
+    int32_t lowDataRate = (regs[MODEM_CONFIG_3_REG] >> 3) & 0x01;
+    uint32_t preamble = (uint32_t)regs[PREAMBLE_MSB_REG] << 8 | regs[PREAMBLE_LSB_REG];
+    if(sf < 6){
+        sf = 6;
+    }
+    if(sf > 12){
+        sf = 12;
+    }
+    int32_t numerator = 8 * payloadLength - 4 * sf + 28 + 16 * crc - 20 * implicitHeader;
+    int32_t denominator = 4 * (sf - 2 * lowDataRate);
+    int32_t blocks = numerator > 0 ? (numerator + denominator - 1) / denominator : 0;
+    //Symbols are counted in quarters to keep the 4.25 preamble tail exact
+    uint64_t quarterSymbols = 4 * (preamble + 8 + (uint32_t)blocks * (cr + 4)) + 17;
+    return quarterSymbols * (1000000000ULL << sf) / 4 / bw;
+}
+
+/**
+ * Output power in dBm from RegPaConfig and RegPaDac.
+ */
+int8_t radioTxPower_dBm(void){
+    uint8_t pa = regs[PA_CONFIG_REG];
+    int8_t outputPower = pa & 0x0F;
+    if(pa & 0x80){
+        if((regs[PA_DAC_REG] & 0x07) == 0x07){
+            return 5 + outputPower; //+20dBm option
+        }
+        return 2 + outputPower; //PA_BOOST
+    }
+    int8_t maxPower = (pa >> 4) & 0x07;
+    return (int8_t)((108 + 6 * maxPower) / 10) - (15 - outputPower); //RFO
+}
+
+/**
+ * Transmit current in uA, interpolated from the RFM95W data sheet figures and
+ * limited by the over current protection setting in RegOcp.
+ */
+static uint32_t txCurrent_uA(void){
+    static const int8_t boost_dBm[] = {2, 13, 17, 20};
+    static const uint32_t boost_uA[] = {24000, 45000, 87000, 120000};
+    static const int8_t rfo_dBm[] = {-4, 7, 13, 15};
+    static const uint32_t rfo_uA[] = {15000, 20000, 29000, 33000};
+    const int8_t *dBm = boost_dBm;
+    const uint32_t *uA = boost_uA;
+    int8_t power = radioTxPower_dBm();
+    uint32_t current;
+    if(!(regs[PA_CONFIG_REG] & 0x80)){
+        dBm = rfo_dBm;
+        uA = rfo_uA;
+    }
+    if(power <= dBm[0]){
+        current = uA[0];
+    }
+    else if(power >= dBm[3]){
+        current = uA[3];
+    }
+    else{
+        uint8_t i = 0;
+        while(power > dBm[i+1]){
+            i++;
+        }
+        current = uA[i] + (uA[i+1] - uA[i]) * (uint32_t)(power - dBm[i]) / (uint32_t)(dBm[i+1] - dBm[i]);
+    }
+    if(regs[OCP_REG] & 0x20){
+        uint8_t trim = regs[OCP_REG] & 0x1F;
+        uint32_t limit_uA = 240000;
+        if(trim <= 15){
+            limit_uA = 45000 + 5000 * (uint32_t)trim;
+        }
+        else if(trim <= 27){
+            limit_uA = 10000 * (uint32_t)trim - 30000;
+        }
+        if(current > limit_uA){
+            current = limit_uA;
+        }
+    }
+    return current;
+}
+
+/**
+ * Starts a transmission of PayloadLength bytes from FifoTxBaseAddr.
+ */
+static void startTx(void){
+    uint8_t base = regs[FIFO_TX_BASE_ADDR_REG];
+    lastPacketLength = regs[PAYLOAD_LENGTH_REG];
+    for(unsigned i=0;i<lastPacketLength;i++){
+        lastPacket[i] = fifo[(uint8_t)(base + i)];
+    }
+    lastPayloadCRC = (regs[MODEM_CONFIG_2_REG] >> 2) & 0x01;
+    lastAirtime_ns = radioTimeOnAir_ns(lastPacketLength);
+    lastTxStart_ns = hostNow();
+    txDoneAt = hostTxLost() ? UINT64_MAX : hostNow() + TX_STARTUP_NS + lastAirtime_ns;
+    packets++;
+}
+
+/**
+ * Writes RegOpMode following the SX1276 rules.
+ */
+static void writeOpMode(uint8_t value){
+    uint8_t old = regs[OP_MODE_REG];
+    uint8_t newMode = value & 0x07;
+    if((old & 0x07) != SLEEP_MODE){
+        value = (uint8_t)((value & ~LORA_MODE) | (old & LORA_MODE)); //LongRangeMode only changes in sleep
+    }
+    regs[OP_MODE_REG] = value;
+    if(newMode == SLEEP_MODE){
+        memset(fifo, 0, sizeof(fifo)); //FIFO is cleared in sleep
+        txDoneAt = UINT64_MAX; //Aborts a transmission
+    }
+    else if((old & 0x07) == SLEEP_MODE){
+        oscReadyAt = hostNow() + OSC_STARTUP_NS;
+    }
+    if(newMode == TX_MODE && (old & 0x07) != TX_MODE && (value & LORA_MODE)){
+        startTx();
+    }
+    else if(newMode != TX_MODE){
+        txDoneAt = UINT64_MAX;
+    }
+}
+
+/**
+ * Status registers the module ignores writes to.
+ */
+static uint8_t readOnly(uint8_t address){
+    return address == FIFO_RX_CURRENT_REG
+        || (address >= RX_NB_BYTES_REG && address <= HOP_CHANNEL_REG)
+        || address == FIFO_RX_BYTE_ADDR_REG
+        || address == VERSION_REG;
+}
+
+void radioSelect(void){
+    addressed = 0;
+}
+
+void radioDeselect(void){
+    addressed = 0;
+}
+
+/**
+ * Handles one SPI byte.  The first byte of a transaction is the address with
+ * bit 7 set for a write.  Each following byte reads or writes that register
+ * and moves on to the next address (burst access), except for the FIFO where
+ * FifoAddrPtr moves instead.
+ */
+uint8_t radioTransfer(uint8_t data){
+    if(!addressed){
+        address = data & 0x7F;
+        write = data & 0x80;
+        addressed = 1;
+        return 0;
+    }
+    uint8_t value;
+    if(address == FIFO_REG){
+        if(mode() == SLEEP_MODE || hostNow() < oscReadyAt){
+            fifoErrors++;
+            return 0; //Not accessible until the oscillator is running
+        }
+        if(write){
+            writeCount[FIFO_REG]++;
+            fifo[regs[FIFO_ADD_PTR_REG]++] = data;
+            return 0;
+        }
+        return fifo[regs[FIFO_ADD_PTR_REG]++];
+    }
+    value = regs[address];
+    if(write){
+        writeCount[address]++;
+        if(address == IRQ_FLAGS_REG){
+            regs[address] &= (uint8_t)~data; //Flags are cleared by writing 1
+        }
+        else if(address == OP_MODE_REG){
+            writeOpMode(data);
+        }
+        else if(!readOnly(address)){
+            regs[address] = data;
+        }
+    }
+    address = (address + 1) & 0x7F;
+    return value;
+}
+
+uint32_t radioCurrent_uA(void){
+    switch(mode()){
+        case SLEEP_MODE:
+            return 0; //0.2uA, already inside the board sleep figure
+        case STANDBY_MODE:
+            return 1600;
+        case FREQ_SYNTH_TX_MODE:
+        case FREQ_SYNTH_RX_MODE:
+            return 5800;
+        case TX_MODE:
+            return txDoneAt == UINT64_MAX ? 1600 : txCurrent_uA();
+        default:
+            return 11500; //Receiving or CAD
+    }
+}
+
+uint64_t radioNextEvent(void){
+    return txDoneAt;
+}
+
+void radioEvent(uint64_t now_ns){
+    if(now_ns >= txDoneAt){
+        txDoneAt = UINT64_MAX;
+        if(!(regs[IRQ_FLAGS_MASK_REG] & IRQ_TX_DONE)){
+            regs[IRQ_FLAGS_REG] |= IRQ_TX_DONE;
+        }
+        regs[OP_MODE_REG] = (uint8_t)((regs[OP_MODE_REG] & 0xF8) | STANDBY_MODE);
+    }
+}
+
+/**
+ * DIO0 pin level.  Mapping 01 in RegDioMapping1 puts TxDone on DIO0.
+ */
+uint8_t radioDIO0(void){
+    switch(regs[DIO_MAPPING_1_REG] >> 6){
+        case 0b01:
+            return (regs[IRQ_FLAGS_REG] & IRQ_TX_DONE) != 0;
+        case 0b00:
+            return (regs[IRQ_FLAGS_REG] & 0x40) != 0; //RxDone
+        default:
+            return (regs[IRQ_FLAGS_REG] & 0x04) != 0; //CadDone
+    }
+}
+
+uint8_t radioRegister(uint8_t address){
+    return regs[address & 0x7F];
+}
+
+uint32_t radioWriteCount(uint8_t address){
+    return writeCount[address & 0x7F];
+}
+
+uint32_t radioFifoErrors(void){
+    return fifoErrors;
+}
+
+uint32_t radioPackets(void){
+    return packets;
+}
+
+uint8_t radioLastPacket(uint8_t *data){
+    memcpy(data, lastPacket, lastPacketLength);
+    return lastPacketLength;
+}
+
+/**
+ * The payload CRC the last packet went with, if the radio added one.
+ * @return 1 if RxPayloadCrcOn was set
+ */
+uint8_t radioLastPayloadCRC(uint16_t *crc){
+    *crc = loraPayloadCRC(lastPacket, lastPacketLength);
+    return lastPayloadCRC;
+}
+
+uint64_t radioLastAirtime_ns(void){
+    return lastAirtime_ns;
+}
+
+uint64_t radioLastTxStart_ns(void){
+    return lastTxStart_ns;
+}
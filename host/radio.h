@@ -0,0 +1,35 @@
+/*
+ * File:   radio.h
+ * Author: Andy Page
+ * Comments: Simulated RFM95W (SX1276) on the far end of SPI2.
+ * Revision history: 1, 15th October 2026
+ */
+
+#ifndef HOST_RADIO_H
+#define	HOST_RADIO_H
+
+#include <stdint.h>
+
+void radioReset(void);
+void radioPowerCycle(void);
+void radioSelect(void);
+uint8_t radioTransfer(uint8_t data);
+void radioDeselect(void);
+uint32_t radioCurrent_uA(void);
+uint64_t radioNextEvent(void); //Simulated time of the next internal event, UINT64_MAX if none
+void radioEvent(uint64_t now_ns);
+uint8_t radioDIO0(void);
+
+//Inspection for the benchmarks, none of these cost simulated time
+uint8_t radioRegister(uint8_t address);
+uint32_t radioWriteCount(uint8_t address);
+uint32_t radioPackets(void);
+uint32_t radioFifoErrors(void);
+uint8_t radioLastPacket(uint8_t *data); //Returns the length
+uint8_t radioLastPayloadCRC(uint16_t *crc); //Returns 1 if the radio sent its payload CRC
+uint64_t radioLastAirtime_ns(void);
+uint64_t radioLastTxStart_ns(void); //Simulated time TX mode was entered
+uint64_t radioTimeOnAir_ns(uint8_t payloadLength); //For the current modem settings
+int8_t radioTxPower_dBm(void);
+
+#endif	/* HOST_RADIO_H */
@@ -0,0 +1,116 @@
+/*
+ * File:   sfr.c
+ * Author: Andy Page
+ * Comments: Storage for the simulated special function registers declared in
+ * host/include/xc.h.
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <xc.h>
+
+volatile TRISAbits_t TRISAbits;
+volatile TRISBbits_t TRISBbits;
+volatile TRISCbits_t TRISCbits;
+volatile TRISDbits_t TRISDbits;
+volatile TRISEbits_t TRISEbits;
+volatile LATAbits_t LATAbits;
+volatile LATBbits_t LATBbits;
+volatile LATCbits_t LATCbits;
+volatile LATDbits_t LATDbits;
+volatile LATEbits_t LATEbits;
+volatile ANSELAbits_t ANSELAbits;
+volatile ANSELBbits_t ANSELBbits;
+volatile ANSELCbits_t ANSELCbits;
+volatile ANSELDbits_t ANSELDbits;
+volatile ANSELEbits_t ANSELEbits;
+
+volatile PMD0bits_t PMD0bits;
+volatile PMD1bits_t PMD1bits;
+volatile PMD2bits_t PMD2bits;
+
+volatile INTCONbits_t INTCONbits;
+volatile INTCON2bits_t INTCON2bits;
+volatile INTCON3bits_t INTCON3bits;
+volatile PIR3bits_t PIR3bits;
+volatile PIE3bits_t PIE3bits;
+volatile PIR1bits_t PIR1bits;
+volatile PIE1bits_t PIE1bits;
+volatile PIR2bits_t PIR2bits;
+volatile PIE2bits_t PIE2bits;
+
+volatile RCONbits_t RCONbits;
+
+volatile OSCCONbits_t OSCCONbits;
+volatile OSCCON2bits_t OSCCON2bits;
+volatile OSCTUNEbits_t OSCTUNEbits;
+
+volatile T1CONbits_t T1CONbits;
+volatile uint8_t TMR1H;
+volatile uint8_t TMR1L;
+volatile T3CONbits_t T3CONbits;
+volatile uint8_t TMR3H;
+volatile uint8_t TMR3L;
+
+volatile EECON1bits_t EECON1bits;
+volatile uint8_t EECON2;
+volatile uint8_t EEADRH;
+volatile uint8_t EEADR;
+volatile uint8_t EEDATA;
+
+volatile ADCON0bits_t ADCON0bits;
+volatile ADCON1bits_t ADCON1bits;
+volatile ADCON2bits_t ADCON2bits;
+volatile VREFCON0bits_t VREFCON0bits;
+volatile uint8_t ADRESH;
+volatile uint8_t ADRESL;
+
+volatile SSP2CON1bits_t SSP2CON1bits;
+volatile SSP2STATbits_t SSP2STATbits;
+volatile uint8_t SSP2BUF;
+volatile uint8_t SSP2IF;
+
+volatile TXSTA2bits_t TXSTA2bits;
+volatile RCSTA2bits_t RCSTA2bits;
+volatile BAUDCON2bits_t BAUDCON2bits;
+volatile uint8_t SPBRGH2;
+volatile uint8_t SPBRG2;
+volatile uint8_t TXREG2;
+
+/**
+ * Loads the power on reset values from the PIC18F46K22 data sheet.
+ */
+void hostSFRReset(void){
+    TRISA = TRISB = TRISC = TRISD = TRISE = 0xFF; //All inputs
+    LATA = LATB = LATC = LATD = LATE = 0;
+    ANSELA = 0x2F;
+    ANSELB = 0x3F;
+    ANSELC = 0xFC;
+    ANSELD = 0xFF;
+    ANSELE = 0x07;
+    PMD0 = PMD1 = PMD2 = 0; //All modules enabled
+    INTCON = 0;
+    INTCON2 = 0xF5;
+    INTCON3 = 0xC0;
+    PIR3 = PIE3 = 0;
+    PIR1 = PIE1 = 0;
+    PIR2 = PIE2 = 0;
+    RCON = 0x1C; //RI, TO and PD set, POR and BOR clear after power on
+    OSCCON = 0x38; //1MHz HFINTOSC selected, OSTS as the crystal has started (FOSC = HSMP)
+    OSCCON2 = 0x84; //PLL locked, crystal drive on
+    OSCTUNE = 0;
+    T1CON = T3CON = 0;
+    TMR1H = TMR1L = TMR3H = TMR3L = 0;
+    EECON1 = EECON2 = 0;
+    EEADRH = EEADR = EEDATA = 0;
+    ADCON0 = ADCON1 = ADCON2 = 0;
+    VREFCON0 = 0x10;
+    ADRESH = ADRESL = 0;
+    SSP2CON1 = SSP2STAT = 0;
+    SSP2BUF = 0;
+    SSP2IF = 0;
+    TXSTA2 = 0x02; //TRMT set
+    RCSTA2 = 0;
+    BAUDCON2 = 0x40;
+    SPBRGH2 = SPBRG2 = 0;
+    TXREG2 = 0;
+}
@@ -0,0 +1,754 @@
+/*
+ * File:   sim.c
+ * Author: Andy Page
+ * Comments: Simulated clock, current model and peripherals for the host build.
+ * Nothing here runs in real time - every wait in the firmware advances the
+ * simulated clock by the time it would take on the PIC, and the supply current
+ * at that moment is integrated into the charge for the current wakeup.
+ * Instruction execution itself is not timed, only the waits.
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xc.h>
+#include "hostsim.h"
+#include "radio.h"
+#include "eeprom.h"
+
+HostConfig hostConfig = {
+    .maxWakes = 10,
+    .battery_mV = 3000,
+    .ntcRatio = 0.5,
+    .echoUart = 0,
+    .radioPowerCycleWake = 0,
+    .txLostWakes = 0,
+    .onWake = 0
+};
+
+static uint64_t now; //Simulated time in ns
+static double totalCharge_uC;
+static uint8_t asleep;
+static uint8_t idle; //Asleep with IDLEN set, the CPU stops but the peripherals keep their clock
+static uint8_t inIsr;
+static uint8_t wakeRequest; //Enabled interrupt flag set while asleep
+static uint8_t dio0; //Last DIO0 level seen on RB2 (INT2)
+
+//EUSART2 transmitter: TXREG2 holds one byte while the shift register sends another
+static uint8_t uartShifting;
+static uint64_t uartShiftEnd;
+static uint8_t uartHolding; //TXREG2 is waiting for the shift register
+static uint32_t uartLost; //Bytes overwritten in TXREG2 or cut off by SLEEP
+
+static uint64_t adcDoneAt = UINT64_MAX; //End of the A to D conversion under way
+
+//Timer1 and Timer3 from Fosc/4.  The count in TMRxH:TMRxL is brought up to
+//date at every step of advance(), so firmware writes to it between waits are
+//picked up.
+typedef struct {
+    volatile uint8_t *control; //T1CON or T3CON, which have the same layout
+    volatile uint8_t *high;
+    volatile uint8_t *low;
+    volatile uint8_t *flags; //PIRx
+    uint8_t flag; //TMRxIF in flags
+    uint8_t disable; //TMRxMD in PMD0
+    uint64_t last; //Time of the last update
+    uint64_t part_ps; //Time since the last count
+} SimTimer;
+
+static SimTimer timers[] = {
+    {&T1CON, &TMR1H, &TMR1L, &PIR1, 0x01, 0x01, 0, 0},
+    {&T3CON, &TMR3H, &TMR3L, &PIR2, 0x02, 0x04, 0, 0}
+};
+#define TIMERS (sizeof(timers) / sizeof(timers[0]))
+static HostWake wake;
+static unsigned wakes;
+static jmp_buf finished;
+static uint64_t selectedAt; //Time SS went low
+static uint32_t packetsAtWake;
+
+static uint64_t *tips;
+static unsigned tipCount;
+static unsigned tipNext;
+static unsigned tipSize;
+
+/**
+ * CPU clock.  OSTS follows the clock actually running, SCS is only the request.
+ */
+static uint32_t foscHz(void){
+    if(OSCCONbits.OSTS){
+        return HOST_FOSC_HZ;
+    }
+    if(OSCCONbits.IRCF == 0){
+        return OSCTUNEbits.INTSRC ? 31250 : HOST_LFINTOSC_HZ;
+    }
+    return 16000000UL >> (7 - OSCCONbits.IRCF);
+}
+
+/**
+ * Only the crystal and LFINTOSC are modelled, HFINTOSC would be charged as
+ * LFINTOSC.
+ */
+static uint32_t mcuCurrent_uA(void){
+    if(asleep && !idle){
+        return HOST_I_MCU_SLEEP_UA;
+    }
+    if(OSCCONbits.OSTS){
+        return HOST_I_MCU_RUN_UA; //Idle at 64MHz is charged as running
+    }
+    uint32_t current = idle ? HOST_I_MCU_LF_IDLE_UA : HOST_I_MCU_LF_RUN_UA;
+    if(OSCCON2bits.PRISD){
+        current += HOST_I_PRIMARY_UA;
+    }
+    return current;
+}
+
+static uint32_t supplyCurrent_uA(void){
+    uint32_t current = mcuCurrent_uA();
+    current += radioCurrent_uA();
+    current += eepromCurrent_uA();
+    if(!TRISEbits.TRISE1 && LATEbits.LATE1){
+        current += HOST_I_LED_UA;
+    }
+    if(!TRISEbits.TRISE2 && LATEbits.LATE2){
+        current += HOST_I_LED_UA;
+    }
+    if(!asleep && !TRISAbits.TRISA2 && !LATAbits.LATA2){
+        current += HOST_I_EXT_UA;
+    }
+    return current;
+}
+
+/**
+ * TRMT2 and TX2IF follow the transmitter state.
+ */
+static void uartFlags(void){
+    TXSTA2bits.TRMT = !uartShifting;
+    PIR3bits.TX2IF = TXSTA2bits.TXEN && !PMD0bits.UART2MD && !uartHolding;
+}
+
+static uint8_t timerRunning(const SimTimer *timer){
+    return (*timer->control & 0x01) //TMRxON
+        && !(PMD0 & timer->disable)
+        && (*timer->control & 0xC0) == 0 //TMRxCS Fosc/4
+        && (!asleep || idle);
+}
+
+static uint64_t timerCount_ps(const SimTimer *timer){
+    return (4000000000000ULL << ((*timer->control >> 4) & 0x03)) / foscHz(); //TxCKPS prescale
+}
+
+/**
+ * Counts the timers up to now and sets TMRxIF when they roll over.
+ */
+static void timersUpdate(void){
+    for(unsigned i=0;i<TIMERS;i++){
+        SimTimer *timer = &timers[i];
+        if(timerRunning(timer)){
+            uint64_t period_ps = timerCount_ps(timer);
+            uint64_t elapsed_ps = (now - timer->last) * 1000 + timer->part_ps;
+            uint64_t count = ((uint32_t)*timer->high << 8 | *timer->low) + elapsed_ps / period_ps;
+            timer->part_ps = elapsed_ps % period_ps;
+            if(count > 0xFFFF){
+                *timer->flags |= timer->flag;
+            }
+            *timer->high = (count >> 8) & 0xFF;
+            *timer->low = count & 0xFF;
+        }
+        else{
+            timer->part_ps = 0;
+        }
+        timer->last = now;
+    }
+}
+
+static uint64_t timersOverflow(void){
+    uint64_t next = UINT64_MAX;
+    for(unsigned i=0;i<TIMERS;i++){
+        const SimTimer *timer = &timers[i];
+        if(timerRunning(timer)){
+            uint64_t left_ps = (0x10000 - ((uint32_t)*timer->high << 8 | *timer->low)) * timerCount_ps(timer) - timer->part_ps;
+            uint64_t overflow = timer->last + (left_ps + 999) / 1000;
+            if(overflow < next){
+                next = overflow;
+            }
+        }
+    }
+    return next;
+}
+
+/**
+ * Runs Isr() while an enabled interrupt flag is set and GIE is on.  The PIC
+ * interrupts are level sensitive on the flags, so this is called after every
+ * event and at the start of every wait, which also catches flags left pending
+ * while the firmware had GIE off.
+ */
+static void serviceInterrupts(void){
+    for(int i=0;i<16;i++){ //The PIC would go straight back into Isr(), give up on a stuck flag
+        uartFlags();
+        uint8_t pending = (INTCON3bits.INT1IF && INTCON3bits.INT1IE)
+                       || (INTCON3bits.INT2IF && INTCON3bits.INT2IE)
+                       || (PIR3bits.TX2IF && PIE3bits.TX2IE && INTCONbits.PEIE)
+                       || (PIR1bits.TMR1IF && PIE1bits.TMR1IE && INTCONbits.PEIE)
+                       || (PIR2bits.TMR3IF && PIE2bits.TMR3IE && INTCONbits.PEIE)
+                       || (PIR2bits.EEIF && PIE2bits.EEIE && INTCONbits.PEIE)
+                       || (PIR1bits.ADIF && PIE1bits.ADIE && INTCONbits.PEIE);
+        if(pending && asleep){
+            wakeRequest = 1;
+        }
+        if(!pending || !INTCONbits.GIE || inIsr){
+            return;
+        }
+        inIsr = 1;
+        Isr();
+        inIsr = 0;
+    }
+}
+
+static void tipEvent(void){
+    INTCON3bits.INT1IF = 1;
+    serviceInterrupts();
+}
+
+/**
+ * INT2 edge detect on DIO0, called whenever the radio state may have changed.
+ */
+static void dio0Changed(void){
+    uint8_t level = radioDIO0();
+    if(level != dio0 && level == INTCON2bits.INTEDG2){
+        INTCON3bits.INT2IF = 1;
+    }
+    dio0 = level;
+    serviceInterrupts();
+}
+
+static uint64_t uartByteNs(void){
+    uint32_t divider = BAUDCON2bits.BRG16 ? (TXSTA2bits.BRGH ? 4 : 16) : (TXSTA2bits.BRGH ? 16 : 64);
+    uint32_t brg = (uint32_t)SPBRGH2 << 8 | SPBRG2;
+    uint64_t baud = foscHz() / (divider * (brg + 1));
+    return 10 * 1000000000ULL / baud; //Start bit, 8 data bits, stop bit
+}
+
+static void uartShift(uint8_t data){
+    uartShifting = 1;
+    uartShiftEnd = now + uartByteNs();
+    wake.uartBytes++;
+    if(hostConfig.echoUart){
+        fputc(data, stdout);
+    }
+}
+
+/**
+ * The shift register has sent its byte, load the next one from TXREG2.
+ */
+static void uartEvent(void){
+    uartShifting = 0;
+    if(uartHolding){
+        uartHolding = 0;
+        uartShift(TXREG2);
+    }
+    serviceInterrupts();
+}
+
+/**
+ * The data EEPROM write has finished.
+ */
+static void eepromDone(void){
+    eepromEvent(now);
+    EECON1bits.WR = 0;
+    PIR2bits.EEIF = 1;
+    serviceInterrupts();
+}
+
+/**
+ * End of an A to D conversion of AN0 (battery through 30k/10k) or AN1 (NTC
+ * divider).
+ */
+static void adcDone(void){
+    double vref = hostConfig.battery_mV;
+    double vin;
+    if(ADCON1bits.PVCFG == 0b10 && VREFCON0bits.FVRS){
+        vref = 1024 << (VREFCON0bits.FVRS - 1);
+    }
+    if(ADCON0bits.CHS == 0){
+        vin = hostConfig.battery_mV / 4.0;
+    }
+    else{
+        vin = hostConfig.battery_mV * hostConfig.ntcRatio;
+    }
+    unsigned result = (unsigned)(vin / vref * 1023.0 + 0.5);
+    if(result > 1023){
+        result = 1023;
+    }
+    if(ADCON2bits.ADFM){
+        ADRESH = result >> 8;
+        ADRESL = result & 0xFF;
+    }
+    else{
+        ADRESH = result >> 2;
+        ADRESL = (result & 0x03) << 6;
+    }
+    adcDoneAt = UINT64_MAX;
+    ADCON0bits.GO_NOT_DONE = 0;
+    PIR1bits.ADIF = 1;
+    serviceInterrupts();
+}
+
+static uint64_t nextEvent(void){
+    uint64_t next = radioNextEvent();
+    if(eepromNextEvent() < next){
+        next = eepromNextEvent();
+    }
+    if(uartShifting && uartShiftEnd < next){
+        next = uartShiftEnd;
+    }
+    if(tipNext < tipCount && tips[tipNext] < next){
+        next = tips[tipNext];
+    }
+    if(timersOverflow() < next){
+        next = timersOverflow();
+    }
+    if(adcDoneAt < next){
+        next = adcDoneAt;
+    }
+    return next;
+}
+
+/**
+ * Moves the simulated clock forward, charging the supply current and
+ * handling any tips or radio events that fall inside the interval.
+ */
+static void advance(uint64_t ns){
+    uint64_t end = now + ns;
+    if(!OSCCONbits.OSTS && !OSCCON2bits.PRISD){
+        OSCCON2bits.PLLRDY = 0; //Crystal stopped, the PLL loses lock
+    }
+    timersUpdate();
+    serviceInterrupts();
+    for(;;){
+        uint64_t next = nextEvent();
+        uint64_t stop = next < end ? next : end;
+        if(stop > now){
+            double charge = (double)supplyCurrent_uA() * (double)(stop - now) * 1e-9;
+            totalCharge_uC += charge;
+            wake.charge_uC += charge; //hostSleep() takes it back off between wakeups
+            now = stop;
+        }
+        timersUpdate();
+        serviceInterrupts();
+        if(next > end){
+            break;
+        }
+        if(radioNextEvent() <= now){
+            radioEvent(now);
+            dio0Changed();
+        }
+        if(uartShifting && uartShiftEnd <= now){
+            uartEvent();
+        }
+        if(eepromNextEvent() <= now){
+            eepromDone();
+        }
+        if(adcDoneAt <= now){
+            adcDone();
+        }
+        while(tipNext < tipCount && tips[tipNext] <= now){
+            tipNext++;
+            tipEvent();
+        }
+        if(next == end){
+            break;
+        }
+    }
+}
+
+static void startWake(HostWakeReason reason){
+    wake = (HostWake){0};
+    wake.reason = reason;
+    wake.start_ns = now;
+    packetsAtWake = radioPackets();
+}
+
+static void endWake(uint64_t at){
+    wake.awake_ns = at - wake.start_ns - wake.sleep_ns;
+    wake.packets = radioPackets() - packetsAtWake;
+    wakes++;
+    if(hostConfig.onWake){
+        hostConfig.onWake(&wake);
+    }
+}
+
+void hostReset(void){
+    now = 0;
+    totalCharge_uC = 0;
+    asleep = 0;
+    idle = 0;
+    inIsr = 0;
+    wakeRequest = 0;
+    dio0 = 0;
+    uartShifting = 0;
+    uartHolding = 0;
+    uartLost = 0;
+    adcDoneAt = UINT64_MAX;
+    for(unsigned i=0;i<TIMERS;i++){
+        timers[i].last = 0;
+        timers[i].part_ps = 0;
+    }
+    wakes = 0;
+    tipCount = 0;
+    tipNext = 0;
+    hostSFRReset();
+    radioReset();
+    eepromErase();
+}
+
+/**
+ * Adds a rain gauge tip (falling edge on INT1) at the given simulated time.
+ * Tips must be scheduled in time order.
+ */
+void hostScheduleTip(uint64_t at_ns){
+    if(tipCount == tipSize){
+        tipSize = tipSize ? tipSize * 2 : 64;
+        tips = realloc(tips, tipSize * sizeof(*tips));
+        if(!tips){
+            abort();
+        }
+    }
+    tips[tipCount++] = at_ns;
+}
+
+/**
+ * Runs the firmware from power on until it has been through
+ * hostConfig.maxWakes wakeups.
+ * @return The number of wakeups simulated.
+ */
+unsigned hostRun(void (*entry)(void)){
+    if(setjmp(finished) == 0){
+        startWake(WAKE_POR);
+        entry();
+    }
+    return wakes;
+}
+
+uint64_t hostNow(void){
+    return now;
+}
+
+double hostTotalCharge_uC(void){
+    return totalCharge_uC;
+}
+
+void hostDelayNs(uint64_t ns){
+    advance(ns);
+}
+
+/**
+ * SLEEP with IDLEN set.  The CPU stops until an enabled interrupt, with the
+ * peripherals still clocked, and carries on without an oscillator start-up.
+ * The time goes in sleep_ns of the current wakeup.
+ */
+static void hostIdle(void){
+    uint64_t idleStart = now;
+    uint64_t watchdog = now + HOST_WDT_NS;
+    RCONbits.NOT_TO = 1;
+    RCONbits.NOT_PD = 0;
+    asleep = 1;
+    idle = 1;
+    wakeRequest = 0;
+    serviceInterrupts();
+    while(now < watchdog && !wakeRequest){
+        uint64_t next = nextEvent();
+        advance((next < watchdog ? next : watchdog) - now);
+    }
+    asleep = 0;
+    idle = 0;
+    if(!wakeRequest){
+        RCONbits.NOT_TO = 0;
+    }
+    wake.sleep_ns += now - idleStart;
+    advance(HOST_IDLE_WAKE_CYCLES * 4000000000ULL / foscHz());
+}
+
+/**
+ * SLEEP instruction.  Sleeps until the watchdog times out or an enabled
+ * interrupt flag is set.  A wake from INT1 or the watchdog starts a new
+ * wakeup; a wake from INT2 (the radio's DIO0) is a sleep inside the current
+ * one, so its time goes in sleep_ns and its charge stays with the wakeup.
+ * With IDLEN set it idles instead, see hostIdle().
+ */
+void hostSleep(void){
+    if(OSCCONbits.IDLEN){
+        hostIdle();
+        return;
+    }
+    uint64_t sleepStart = now;
+    double chargeAtSleep = totalCharge_uC;
+    double wakeCharge = wake.charge_uC;
+    HostWakeReason reason = WAKE_WDT;
+    uint64_t watchdog = now + HOST_WDT_NS;
+    RCONbits.NOT_TO = 1;
+    RCONbits.NOT_PD = 0;
+    if(uartShifting || uartHolding){
+        uartLost += uartShifting + uartHolding; //The baud rate clock stops in sleep
+        uartShifting = uartHolding = 0;
+    }
+    asleep = 1;
+    wakeRequest = 0;
+    serviceInterrupts();
+    while(now < watchdog && !wakeRequest){
+        uint64_t next = nextEvent();
+        advance((next < watchdog ? next : watchdog) - now);
+    }
+    asleep = 0;
+    if(wakeRequest){
+        reason = INTCON3bits.INT2IF && INTCON3bits.INT2IE ? WAKE_INT2 : WAKE_INT1;
+    }
+    else{
+        RCONbits.NOT_TO = 0; //Watchdog time-out
+    }
+    if(reason == WAKE_INT2){
+        wake.sleep_ns += now - sleepStart;
+        advance(HOST_WAKE_START_NS);
+        return;
+    }
+    wake.charge_uC = wakeCharge;
+    endWake(sleepStart);
+    if(wakes >= hostConfig.maxWakes){
+        now = sleepStart; //Finish at the SLEEP that ended the last wakeup
+        totalCharge_uC = chargeAtSleep;
+        while(tipNext > 0 && tips[tipNext - 1] >= sleepStart){
+            tipNext--; //Leave out the tips that woke it
+        }
+        longjmp(finished, 1);
+    }
+    if(hostConfig.radioPowerCycleWake == wakes){
+        radioPowerCycle();
+        dio0Changed();
+    }
+    startWake(reason);
+    advance(HOST_WAKE_START_NS);
+}
+
+uint8_t hostTxLost(void){
+    return wakes < hostConfig.txLostWakes;
+}
+
+void hostClearWDT(void){
+    RCONbits.NOT_TO = 1;
+    RCONbits.NOT_PD = 1;
+}
+
+/**
+ * GIE set by the firmware.  The PIC goes straight into Isr() if a flag is
+ * pending.
+ */
+void hostInterruptsOn(void){
+    INTCONbits.GIE = 1;
+    serviceInterrupts();
+}
+
+/**
+ * Clock switch to the internal oscillator block.  LFINTOSC is always running
+ * for the watchdog, so the switch is taken as immediate.
+ */
+void hostClockInternal(void){
+    if(OSCCONbits.SCS & 0b10){
+        OSCCONbits.OSTS = 0;
+    }
+}
+
+/**
+ * Clock switch back to the crystal.  If the crystal was stopped (PRISD) this
+ * waits for the oscillator start-up timer and PLL lock on the slow clock.
+ */
+void hostClockPrimary(void){
+    if(!OSCCONbits.OSTS && OSCCONbits.SCS == 0){
+        if(!OSCCON2bits.PLLRDY){
+            advance(HOST_WAKE_START_NS);
+        }
+        OSCCONbits.OSTS = 1;
+        OSCCON2bits.PLLRDY = 1;
+    }
+}
+
+/**
+ * SPI2 byte time from the MSSP2 clock select bits.
+ */
+static uint64_t spiByteNs(void){
+    switch(SSP2CON1bits.SSPM){
+        case 0b0000:
+            return 8 * 4 * 1000000000ULL / foscHz();
+        case 0b0001:
+            return 8 * 16 * 1000000000ULL / foscHz();
+        default:
+            return 8 * 64 * 1000000000ULL / foscHz();
+    }
+}
+
+void hostSPI2Select(void){
+    LATDbits.LATD3 = 0;
+    selectedAt = now;
+    wake.spiTransactions++;
+    radioSelect();
+}
+
+uint8_t hostSPI2Transfer(uint8_t data){
+    advance(spiByteNs());
+    wake.spiBytes++;
+    if(!SSP2CON1bits.SSPEN || PMD1bits.MSSP2MD){
+        return 0;
+    }
+    SSP2BUF = radioTransfer(data);
+    return SSP2BUF;
+}
+
+void hostSPI2Deselect(void){
+    LATDbits.LATD3 = 1;
+    wake.spiSelect_ns += now - selectedAt;
+    radioDeselect();
+    dio0Changed();
+}
+
+
+/**
+ * Tad from ADCS, the FRC oscillator is taken as its typical 1.7us.
+ */
+static uint64_t adcTadNs(void){
+    static const uint8_t divider[] = {2, 8, 32, 0, 4, 16, 64, 0};
+    uint8_t adcs = ADCON2bits.ADCS;
+    if(!divider[adcs]){
+        return 1700;
+    }
+    return divider[adcs] * 1000000000ULL / foscHz();
+}
+
+/**
+ * GO/DONE set.  The conversion takes the acquisition time (ACQT) and 11 Tad,
+ * then sets ADIF.  Nothing happens with the A to D turned off.
+ */
+void hostADCStart(void){
+    static const uint8_t acquisition[] = {0, 2, 4, 6, 8, 12, 16, 20}; //Tad for each ACQT
+    if(!ADCON0bits.ADON || PMD2bits.ADCMD){
+        return;
+    }
+    ADCON0bits.GO_NOT_DONE = 1;
+    adcDoneAt = now + (acquisition[ADCON2bits.ACQT] + 11) * adcTadNs();
+}
+
+/**
+ * The firmware waiting on a conversion, which moves the clock on to the end
+ * of it.
+ */
+void hostADCWait(void){
+    if(adcDoneAt == UINT64_MAX){
+        fprintf(stderr, "waiting on an A to D conversion that was never started\n");
+        abort();
+    }
+    advance(adcDoneAt - now);
+}
+
+/**
+ * TRMT2.  Polling costs time, so when the transmitter is busy this moves the
+ * clock on to the end of the current byte before answering.
+ */
+uint8_t hostUART2TxIdle(void){
+    serviceInterrupts();
+    if(uartShifting){
+        advance(uartShiftEnd - now);
+    }
+    uartFlags();
+    return TXSTA2bits.TRMT;
+}
+
+/**
+ * TX2IF, polled the same way as TRMT2.
+ */
+uint8_t hostUART2TxReady(void){
+    serviceInterrupts();
+    if(!PIR3bits.TX2IF && uartShifting){
+        advance(uartShiftEnd - now);
+        uartFlags();
+    }
+    return PIR3bits.TX2IF;
+}
+
+/**
+ * Write to TXREG2.  Goes straight to the shift register if it is idle,
+ * otherwise waits in TXREG2.
+ */
+void hostUART2Write(uint8_t data){
+    TXREG2 = data;
+    if(!uartShifting){
+        uartShift(data);
+    }
+    else if(!uartHolding){
+        uartHolding = 1;
+    }
+    else{
+        uartLost++; //Overwrote the byte in TXREG2
+    }
+    uartFlags();
+}
+
+/**
+ * EECON1 RD.  Only the data EEPROM is modelled, not program memory or the
+ * configuration bits.
+ */
+void hostEepromRead(void){
+    if(!EECON1bits.EEPGD && !EECON1bits.CFGS){
+        EEDATA = eepromRead((uint16_t)EEADRH << 8 | EEADR);
+    }
+}
+
+/**
+ * EECON1 WR after the unlock sequence.  The PIC ignores it unless WREN is
+ * set, and interrupts have to be off or the sequence can be broken up.
+ */
+void hostEepromWrite(void){
+    if(!EECON1bits.WREN || EECON1bits.WR || INTCONbits.GIE || EECON1bits.EEPGD || EECON1bits.CFGS){
+        EECON1bits.WRERR = 1;
+        return;
+    }
+    EECON1bits.WR = 1;
+    eepromStartWrite(now, (uint16_t)EEADRH << 8 | EEADR, EEDATA);
+}
+
+/**
+ * Waits for EECON1 WR to clear.  The firmware sleeps through it with IDLEN
+ * set (clockIdle()), otherwise it is taken as polling at full speed.
+ */
+void hostEepromWait(void){
+    while(EECON1bits.WR){
+        if(OSCCONbits.IDLEN){
+            hostIdle();
+        }
+        else{
+            advance(eepromNextEvent() - now);
+        }
+    }
+}
+
+uint32_t hostUARTLost(void){
+    return uartLost;
+}
+
+uint32_t hostTipEdges(void){
+    return tipNext;
+}
+
+/**
+ * XC8 printf, which sends each character through putch().
+ */
+int hostPrintf(const char *format, ...){
+    char buffer[128];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    for(int i=0;i<length && i<(int)sizeof(buffer)-1;i++){
+        putch(buffer[i]);
+    }
+    return length;
+}
@@ -0,0 +1,184 @@
+/*
+ * File:   throughput.cpp
+ * Author: Andy Page
+ * Comments: Checks the host CRC16 library (crc16.hpp) against the firmware's
+ * CRC16.c and measures it in GB/s, over one long buffer as when checking an
+ * archive, and with verify() over batches of 50 byte packets as when
+ * ingesting them.  Every method is checked against CRC16() for every length
+ * up to 1100 bytes at each alignment, carrying on from an earlier CRC16, and
+ * verify() against packets with every 7th one corrupted.  Exits non-zero on
+ * any mismatch.  Methods the processor lacks are reported and skipped.
+ *
+ * Usage: crc16-throughput [-m MB] [-b packets]
+ *   -m  bytes run through each method, in MB
+ *   -b  packets in each verify() call
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "crc16.hpp"
+#include "packet.h"
+
+//CRC16.c from the firmware, without CRC16.h as that includes xc.h
+extern "C" unsigned short int CRC16(const unsigned char *, unsigned short int);
+
+#define CHECK_LENGTHS 1100
+#define ALIGNMENTS 8
+#define CORRUPT_EVERY 7
+#define ARCHIVE_BYTES (1 << 20) //Buffer the long runs go round
+
+static volatile size_t sink; //Keeps the work
+
+static double now_s(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/**
+ * Packets of DATA_PACKET_LENGTH bytes, each with its CRC16 and every
+ * CORRUPT_EVERY th one with a bit flipped after.
+ */
+static std::vector<uint8_t> makePackets(size_t count){
+    std::vector<uint8_t> packets(count * DATA_PACKET_LENGTH);
+    for(size_t i=0;i<count;i++){
+        uint8_t *packet = &packets[i * DATA_PACKET_LENGTH];
+        for(size_t j=0;j<DATA_PACKET_CRC_AT;j++){
+            packet[j] = (uint8_t)rand();
+        }
+        unsigned short int crc = CRC16(packet, DATA_PACKET_CRC_AT);
+        packet[DATA_PACKET_CRC_AT] = crc & 0xFF;
+        packet[DATA_PACKET_CRC_AT + 1] = crc >> 8;
+        if(i % CORRUPT_EVERY == CORRUPT_EVERY - 1){
+            packet[rand() % DATA_PACKET_LENGTH] ^= (uint8_t)(1 << (rand() % 8));
+        }
+    }
+    return packets;
+}
+
+/**
+ * @return Mismatches against CRC16.c
+ */
+static unsigned check(crc16::Method method){
+    unsigned errors = 0;
+    static const uint8_t checkString[] = "123456789";
+    errors += crc16::compute(method, checkString, 9) != 0x4B37;
+    std::vector<uint8_t> data(CHECK_LENGTHS + ALIGNMENTS);
+    for(auto &byte : data){
+        byte = (uint8_t)rand();
+    }
+    for(size_t length=0;length<=CHECK_LENGTHS;length++){
+        for(size_t align=0;align<ALIGNMENTS;align++){
+            const uint8_t *start = &data[align];
+            unsigned short int expected = CRC16(start, (unsigned short int)length);
+            errors += crc16::compute(method, start, length) != expected;
+            size_t split = length / 3;
+            errors += crc16::compute(method, start + split, length - split,
+                                     crc16::compute(method, start, split)) != expected;
+        }
+    }
+
+    size_t count = 1000 + 3; //Not a whole number of batches
+    std::vector<uint8_t> packets = makePackets(count);
+    std::vector<uint8_t> ok(count);
+    size_t passed = crc16::verify(method, packets.data(), count, DATA_PACKET_LENGTH, DATA_PACKET_LENGTH, ok.data());
+    size_t expectedPassed = 0;
+    for(size_t i=0;i<count;i++){
+        const uint8_t *packet = &packets[i * DATA_PACKET_LENGTH];
+        unsigned short int crc = CRC16(packet, DATA_PACKET_CRC_AT);
+        uint8_t good = packet[DATA_PACKET_CRC_AT] == (crc & 0xFF) && packet[DATA_PACKET_CRC_AT + 1] == (crc >> 8);
+        errors += ok[i] != good;
+        expectedPassed += good;
+    }
+    errors += passed != expectedPassed;
+    return errors;
+}
+
+int main(int argc, char **argv){
+    double megabytes = 256;
+    size_t batch = 4096;
+    int option;
+
+    while((option = getopt(argc, argv, "m:b:")) != -1){
+        switch(option){
+            case 'm':
+                megabytes = atof(optarg);
+                break;
+            case 'b':
+                batch = (size_t)atol(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-m MB] [-b packets]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(batch < 1){
+        batch = 1;
+    }
+
+    srand(1);
+    std::vector<uint8_t> archive(ARCHIVE_BYTES);
+    for(auto &byte : archive){
+        byte = (uint8_t)rand();
+    }
+    std::vector<uint8_t> packets = makePackets(batch);
+    std::vector<uint8_t> ok(batch);
+    double bytes = megabytes * 1e6;
+    unsigned long rounds = (unsigned long)(bytes / ARCHIVE_BYTES) + 1;
+    unsigned long calls = (unsigned long)(bytes / ((double)batch * DATA_PACKET_LENGTH)) + 1;
+    unsigned errors = 0;
+
+    printf("%-14s %9s %9s %12s  %s\n", "method", "archive", "packets", "packets", "same as");
+    printf("%-14s %9s %9s %12s  %s\n", "", "GB/s", "GB/s", "per second", "CRC16.c");
+    {
+        //The firmware's own loop as the baseline
+        unsigned crc = 0;
+        double start = now_s();
+        for(unsigned long i=0;i<rounds;i++){
+            crc ^= CRC16(archive.data(), 0xFFFF);
+        }
+        double archiveGBs = (double)rounds * 0xFFFF / (now_s() - start) / 1e9;
+        start = now_s();
+        for(unsigned long i=0;i<calls;i++){
+            for(size_t j=0;j<batch;j++){
+                crc ^= CRC16(&packets[j * DATA_PACKET_LENGTH], DATA_PACKET_CRC_AT);
+            }
+        }
+        double seconds = now_s() - start;
+        sink = crc;
+        printf("%-14s %9.2f %9.2f %12.3g\n", "CRC16.c", archiveGBs,
+               (double)calls * batch * DATA_PACKET_LENGTH / seconds / 1e9, (double)calls * batch / seconds);
+    }
+    for(crc16::Method method : crc16::METHODS){
+        if(!crc16::supported(method)){
+            printf("%-14s not supported by this processor\n", crc16::name(method));
+            continue;
+        }
+        unsigned mismatches = check(method);
+        errors += mismatches;
+        unsigned crc = 0;
+        double start = now_s();
+        for(unsigned long i=0;i<rounds;i++){
+            crc ^= crc16::compute(method, archive.data(), archive.size());
+        }
+        double archiveGBs = (double)rounds * archive.size() / (now_s() - start) / 1e9;
+        size_t passed = 0;
+        start = now_s();
+        for(unsigned long i=0;i<calls;i++){
+            passed += crc16::verify(method, packets.data(), batch, DATA_PACKET_LENGTH, DATA_PACKET_LENGTH, ok.data());
+        }
+        double seconds = now_s() - start;
+        sink = crc ^ passed;
+        printf("%-14s %9.2f %9.2f %12.3g  %s%s\n", crc16::name(method), archiveGBs,
+               (double)calls * batch * DATA_PACKET_LENGTH / seconds / 1e9, (double)calls * batch / seconds,
+               mismatches ? "NO" : "yes", method == crc16::fastest() ? ", picked" : "");
+    }
+    printf("checked        \"123456789\" is 0x4B37, lengths 0 to %u at %u alignments, and verify() of %u byte packets\n",
+           CHECK_LENGTHS, ALIGNMENTS, DATA_PACKET_LENGTH);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+/*
+ * File:   wear.c
+ * Author: Andy Page
+ * Comments: Runs the firmware's EEPROM journal (journal.c) through years of
+ * simulated rain against the simulated data EEPROM and reports how the writes
+ * are spread over the cells.  Power failures are injected part way through
+ * checkpoints and in between, and the recovered counts are checked.
+ * The firmware's main loop is not run, only one journalWake() and checkpoint
+ * per watchdog period, so ten years takes well under a second.
+ *
+ * Usage: eeprom-wear [-y years] [-r tips per year] [-f power failures] [-s seed]
+ * Revision history: 1, 15th October 2026
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "hostsim.h"
+#include "eeprom.h"
+#include "journal.h"
+#include "backlog.h"
+
+#define STEPS_PER_YEAR (365.25 * 24 * 3600e9 / HOST_WDT_NS)
+#define STORMS_PER_YEAR 60
+#define STORM_STEPS 82 //About 3 hours on average
+
+static jmp_buf powerFailed;
+static uint64_t seed = 1;
+
+//The journal is run without the rest of the firmware
+void Isr(void){
+}
+
+void putch(char c){
+    (void)c;
+}
+
+/**
+ * xorshift64, so runs are repeatable for a given seed.
+ */
+static uint32_t randomNumber(void){
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)(seed >> 32);
+}
+
+static double randomFraction(void){
+    return randomNumber() / 4294967296.0;
+}
+
+static void powerFail(void){
+    eepromPowerFail();
+    longjmp(powerFailed, 1);
+}
+
+int main(int argc, char **argv){
+    double years = 10;
+    double tipsPerYear = 7500; //1500mm at 0.2mm a tip
+    unsigned failures = 100;
+    int option;
+
+    while((option = getopt(argc, argv, "y:r:f:s:")) != -1){
+        switch(option){
+            case 'y':
+                years = atof(optarg);
+                break;
+            case 'r':
+                tipsPerYear = atof(optarg);
+                break;
+            case 'f':
+                failures = (unsigned)atoi(optarg);
+                break;
+            case 's':
+                seed = strtoull(optarg, 0, 0) | 1;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-y years] [-r tips per year] [-f power failures] [-s seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    hostReset(); //Blank EEPROM
+    uint64_t steps = (uint64_t)(years * STEPS_PER_YEAR);
+    double stormTips = tipsPerYear / STORMS_PER_YEAR / STORM_STEPS; //Mean tips per step in a storm
+    uint32_t tips = 0;
+    uint32_t messages = 0;
+    uint32_t checkpoints = 0;
+    uint32_t writesBefore = 0;
+    uint32_t mostWrites = 0; //In one checkpoint
+    uint32_t recovered = 0;
+    uint32_t torn = 0; //Power failures part way through a checkpoint
+    uint32_t errors = 0;
+    uint32_t tipsLost = 0;
+    uint32_t mostTipsLost = 0;
+    uint32_t mostReads = 0; //In one journalRecover()
+    uint32_t committedTips = 0;
+    uint8_t storm = 0;
+    uint32_t mostMessagesSkipped = 0;
+
+    uint32_t savedTips;
+    uint32_t savedMessages;
+    journalRecover(&savedTips, &savedMessages);
+    for(uint64_t step=0;step<steps;step++){
+        if(storm){
+            storm = randomFraction() >= 1.0 / STORM_STEPS;
+        }
+        else{
+            storm = randomFraction() < STORMS_PER_YEAR / STEPS_PER_YEAR;
+        }
+        uint32_t newTips = storm ? (uint32_t)(randomFraction() * (2 * stormTips + 1)) : 0;
+        tips += newTips;
+        //The regular report and up to 4 tip windows, each draining the backlog
+        messages += (1 + BACKLOG_DRAIN_PACKETS) * (1 + (newTips < 4 ? newTips : 4));
+        journalWake();
+
+        //Power failures come at random, some of them part way through a checkpoint
+        uint8_t fail = failures && randomFraction() < failures / (double)steps;
+        uint8_t due = journalDue(tips, messages);
+        if(fail && due){
+            eepromFailAt(1 + randomNumber() % JOURNAL_RECORD, powerFail);
+        }
+        if(setjmp(powerFailed) == 0){
+            if(due){
+                journalCommit(tips, messages);
+                eepromFailAt(0, 0);
+                checkpoints++;
+                committedTips = tips;
+                uint32_t written = eepromWrites() - writesBefore;
+                if(written > mostWrites){
+                    mostWrites = written;
+                }
+                writesBefore = eepromWrites();
+            }
+            if(!fail || due){
+                continue; //A failure during a checkpoint comes back here through longjmp()
+            }
+        }
+        torn += due;
+        writesBefore = eepromWrites();
+
+        //Power back on, the firmware starts again with what it finds
+        hostSFRReset();
+        uint32_t readsBefore = eepromReads();
+        if(!journalRecover(&savedTips, &savedMessages)){
+            savedTips = 0;
+            savedMessages = 0;
+        }
+        if(eepromReads() - readsBefore > mostReads){
+            mostReads = eepromReads() - readsBefore;
+        }
+        recovered++;
+        if(savedTips != committedTips && savedTips != tips){
+            errors++; //Neither the last checkpoint nor the one that was cut short
+        }
+        if(savedMessages < messages){
+            errors++; //Message counts would be sent again
+        }
+        if(tips - savedTips > mostTipsLost){
+            mostTipsLost = tips - savedTips;
+        }
+        if(savedMessages - messages > mostMessagesSkipped){
+            mostMessagesSkipped = savedMessages - messages;
+        }
+        tipsLost += tips - savedTips;
+        tips = savedTips;
+        committedTips = savedTips;
+        messages = savedMessages;
+    }
+
+    uint32_t least = UINT32_MAX;
+    uint32_t most = 0;
+    double total = 0;
+    for(uint16_t i=0;i<JOURNAL_SLOTS * JOURNAL_RECORD;i++){
+        uint32_t wear = eepromWear(i);
+        total += wear;
+        if(wear < least){
+            least = wear;
+        }
+        if(wear > most){
+            most = wear;
+        }
+    }
+    printf("simulated        %.1f years, %llu watchdog wakes, %u tips, %u messages\n",
+           years, (unsigned long long)steps, tips, messages);
+    printf("checkpoints      %u, %.1f a day, every %u tips or %u wakes\n",
+           checkpoints, checkpoints / (years * 365.25), JOURNAL_TIPS, JOURNAL_WAKES);
+    printf("bytes written    %u, %.2f per checkpoint (record is %u), at most %u in one\n",
+           eepromWrites(), checkpoints ? (double)eepromWrites() / checkpoints : 0.0, JOURNAL_RECORD, mostWrites);
+    printf("wear per byte    %u least, %.0f mean, %u most over %u slots of %u bytes\n",
+           least, total / (JOURNAL_SLOTS * JOURNAL_RECORD), most, JOURNAL_SLOTS, JOURNAL_RECORD);
+    printf("endurance        %.2f%% of %lu cycles used, about %.0f years to wear out the most used byte\n",
+           most * 100.0 / EEPROM_ENDURANCE, EEPROM_ENDURANCE, most ? EEPROM_ENDURANCE * years / most : 0.0);
+    printf("wear by field    ");
+    static const char *fields[JOURNAL_RECORD] = {"hdr", "t3", "t2", "t1", "t0", "m3", "m2", "m1", "m0", "crcL", "crcH"};
+    for(uint8_t i=0;i<JOURNAL_RECORD;i++){
+        double sum = 0;
+        for(uint8_t slot=0;slot<JOURNAL_SLOTS;slot++){
+            sum += eepromWear(slot * JOURNAL_RECORD + i);
+        }
+        printf("%s %.0f%s", fields[i], sum / JOURNAL_SLOTS, i < JOURNAL_RECORD - 1 ? ", " : "\n");
+    }
+    printf("power failures   %u (%u during a checkpoint), %u counts wrong after recovery, %u tips lost (at most %u at once)\n",
+           recovered, torn, errors, tipsLost, mostTipsLost);
+    printf("recovery         at most %u EEPROM reads, message count moved on by at most %u\n",
+           mostReads, mostMessagesSkipped);
+    return errors ? 1 : 0;
+}